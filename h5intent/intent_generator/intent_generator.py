@@ -6,6 +6,7 @@ from enum import Enum
 import json
 import argparse
 import os
+import re
 import numpy as np
 from pathlib import Path
 '''
@@ -25,6 +26,20 @@ class AccessPatternType(Enum):
     READ_ONLY = 1
     RAW = 2
     OTHER = 3
+def rank_ranges(ranks):
+    """ {"ranges": [[first, last], ...]} for a collection of ranks. """
+    ranges = []
+    for rank in sorted(int(r) for r in ranks):
+        if ranges and ranges[-1][1] + 1 >= rank:
+            ranges[-1][1] = max(ranges[-1][1], rank)
+        else:
+            ranges.append([rank, rank])
+    return {"ranges": ranges}
+def rank_count(process_sharing):
+    if isinstance(process_sharing, dict):
+        return sum(last - first + 1 for first, last in process_sharing.get("ranges", [])) + \
+               len(process_sharing.get("ranks", []))
+    return len(process_sharing)
 class MultiSessionIO:
     open_timestamp: tuple() = (0,0)
     close_timestamp: tuple() = (0,0)
@@ -61,7 +76,10 @@ class DatasetIOIntents:
         return str(self.json())
 
     def json(self):
+        # sharing first, so loaders filtering by rank can skip the rest early
         return {
+            'sharing_pattern': self.sharing_pattern.value,
+            'process_sharing': rank_ranges(self.process_sharing),
             'filename': self.filename,
             'dataset_name': self.dataset_name,
             'ndims': self.ndims,
@@ -69,9 +87,7 @@ class DatasetIOIntents:
             'type': self.type.value,
             'top_accessed_segments': self.top_accessed_segments,
             'transfer_size_dist': self.transfer_size_dist,
-            'process_sharing': self.process_sharing,
             'fs_size': self.fs_size,
-            'sharing_pattern': self.sharing_pattern.value,
             'mode': self.mode.value,
         }
 
@@ -89,21 +105,22 @@ class FileIOIntents:
     transfer_size_dist = {}
     process_sharing = []
     ds_size_dist = {}
+    group_count = 0
     def __repr__(self):
         return str(self.json())
 
     def json(self):
         return {
+            'sharing_pattern': self.sharing_pattern.value,
+            'process_sharing': rank_ranges(self.process_sharing),
             'session_io': self.session_io.json(),
             'mode': self.mode.value,
-            'process_sharing': self.process_sharing,
             'fs_size': self.fs_size,
-            'sharing_pattern': self.sharing_pattern.value,
             'ap_distribution': self.ap_distribution,
             'top_accessed_segments': self.top_accessed_segments,
             'transfer_size_dist': self.transfer_size_dist,
-            'process_sharing': self.process_sharing,
             'ds_size_dist': self.ds_size_dist,
+            'group_count': self.group_count,
         }
 class Intents:
     def __init__(self):
@@ -139,12 +156,43 @@ class NpEncoder(json.JSONEncoder):
         if hasattr(obj, 'json'):
             return obj.json()
         return super(NpEncoder, self).default(obj)
+''' rank patterns '''
+RANK_IN_NAME = re.compile(r'rank_\d+_')
+RANK_PATTERN = 'rank_{rank}_'
+def collapse_rank_patterns(configuration):
+    """
+    Replace per-rank entries (rank_0_test.h5, rank_1_test.h5, ...) by one
+    rank_{rank}_test.h5 entry when they only differ in their names and ranks.
+    """
+    collapsed = {}
+    for section, name_fields in (('files', ['filename']), ('datasets', ['filename', 'dataset_name'])):
+        groups = {}
+        for key, value in configuration[section].items():
+            groups.setdefault(RANK_IN_NAME.sub(RANK_PATTERN, key), []).append((key, value))
+        entries = {}
+        for pattern, members in groups.items():
+            ignored = set(name_fields + ['process_sharing'])
+            def signature(value):
+                return json.dumps({k: v for k, v in value.items() if k not in ignored}, sort_keys=True)
+            first = members[0][1]
+            if len(members) == 1 or any(signature(value) != signature(first) or rank_count(value['process_sharing']) != 1
+                                        for _, value in members):
+                entries.update(members)
+                continue
+            entry = dict(first)
+            for field in name_fields:
+                if field in entry:
+                    entry[field] = RANK_IN_NAME.sub(RANK_PATTERN, entry[field])
+            entries[pattern] = entry
+        collapsed[section] = entries
+    return collapsed
 '''
 Main Class
 '''
 class IntentGenerator:
-    def __init__(self, base_path, darshan_logs, property_json, workflow, data_dirs):
+    def __init__(self, base_path, darshan_logs, property_json, workflow, data_dirs, rank_patterns=False):
         self.base_path = base_path
+        self.rank_patterns = rank_patterns
         self.darshan_logs = darshan_logs
         self.property_json = property_json
         self.workflow = workflow
@@ -183,7 +231,10 @@ class IntentGenerator:
         json_files = []
         for app_name, value in self.app.items():
             if self.found_hdf5:
-                json_object = json.dumps(self.app[app_name]['configuration'], cls=NpEncoder, indent=2)
+                configuration = self.app[app_name]['configuration']
+                if self.rank_patterns:
+                    configuration = collapse_rank_patterns(json.loads(json.dumps(configuration, cls=NpEncoder)))
+                json_object = json.dumps(configuration, cls=NpEncoder, indent=2)
                 folder = f"{self.base_path}/{self.property_json}/{self.workflow}"
                 if not os.path.exists(folder):
                     Path(folder).mkdir(parents=True)
@@ -256,6 +307,8 @@ class IntentGenerator:
                                             "3":{"sum":0, "count":0},"4":{"sum":0, "count":0}},
                     'process_sharing': set(),
                     'ds_size_dist': {"sum":0, "count":0},
+                    'groups': set(),
+                    'sharing': set(),
                 }
             
             
@@ -314,12 +367,15 @@ class IntentGenerator:
                 dataset_intents.sharing_pattern = SharingPattern.COLLECTIVE
                 dataset_intents.process_sharing = list(range(self.app[app_name]['num_processes']))
             file_agg[file_id]['process_sharing'].update(dataset_intents.process_sharing)
+            file_agg[file_id]['sharing'].add(dataset_intents.sharing_pattern)
             dataset_intents.fs_size = h5d_df_c['H5D_BYTES_WRITTEN'][ind] \
                                         if h5d_df_c['H5D_BYTES_WRITTEN'][ind] > h5d_df_c['H5D_BYTES_READ'][ind] \
                                         else h5d_df_c['H5D_BYTES_READ'][ind]
             file_agg[file_id]["fs_size"] += dataset_intents.fs_size
             file_agg[file_id]["ds_size_dist"]["sum"] += dataset_intents.fs_size
             file_agg[file_id]["ds_size_dist"]["count"] += 1
+            dataset_path = dset_split_fqn[-1] if len(dset_split_fqn) > 1 else "/"
+            file_agg[file_id]["groups"].add(dataset_path.rsplit("/", 1)[0] or "/")
             self.app[app_name]['configuration'].datasets[dataset_intents.dataset_name] = dataset_intents
             #print(dataset_intents)
         self.app[app_name]['file_agg'] = file_agg
@@ -350,13 +406,17 @@ class IntentGenerator:
                 file_item.mode = FileMode.READ_WRITE
             file_item.fs_size = file_agg_item["fs_size"]
             file_item.process_sharing = list(file_agg_item["process_sharing"])
+            # collective only if every rank opens every dataset, as collective
+            # metadata reads need all ranks in every metadata operation.
             file_item.sharing_pattern = SharingPattern.INDEPENDENT
             if len(file_item.process_sharing) > 1:
-                file_item.sharing_pattern = SharingPattern.COLLECTIVE
+                file_item.sharing_pattern = SharingPattern.COLLECTIVE \
+                    if file_agg_item["sharing"] == {SharingPattern.COLLECTIVE} else SharingPattern.OTHER
             file_item.ap_distribution = file_agg_item["ap_distribution"]
             file_item.top_accessed_segments = file_agg_item["top_accessed_segments"]
             file_item.transfer_size_dist = file_agg_item["transfer_size_dist"]
             file_item.ds_size_dist = file_agg_item["ds_size_dist"]
+            file_item.group_count = len(file_agg_item["groups"])
             self.app[app_name]['configuration'].files[file_item.filename] = file_item
         return self.app[app_name]['configuration']
 def parse_args():
@@ -367,6 +427,8 @@ def parse_args():
     parser.add_argument("--property-json", default="", type=str, help="Property json dir relative to base path")
     parser.add_argument("--data-dirs", default="/p/gpfs", type=str, help="Directory to include in analysis")
     parser.add_argument("--workflow", default="", type=str, help="Workflow to run")
+    parser.add_argument("--rank-patterns", action="store_true",
+                        help="Collapse per-rank files and datasets into rank_{rank}_ pattern keys")
     return parser.parse_args()
 
 
@@ -377,13 +439,15 @@ def main():
         print(f"Generating config for whole folder {folder}")
         for workflow in os.listdir(folder):
             print(f"Generating config for workflow {workflow}")
-            generator = IntentGenerator(args.base_path, args.darshan_logs, args.property_json, workflow, args.data_dirs)
+            generator = IntentGenerator(args.base_path, args.darshan_logs, args.property_json, workflow, args.data_dirs,
+                                        args.rank_patterns)
             generator.parse_apps()
             generator.load_apps()
             generator.write_configurations()
     else:
         print(f"Generating config for workflow {args.workflow}")
-        generator = IntentGenerator(args.base_path, args.darshan_logs, args.property_json, args.workflow, args.data_dirs)
+        generator = IntentGenerator(args.base_path, args.darshan_logs, args.property_json, args.workflow, args.data_dirs,
+                                    args.rank_patterns)
         generator.parse_apps()
         generator.load_apps()
         generator.write_configurations()
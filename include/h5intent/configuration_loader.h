@@ -8,7 +8,10 @@
 #ifdef __cplusplus
 #include <nlohmann/json.hpp>
 #include <h5intent/property_dds.h>
+#include <h5intent/compiled_intents.h>
+#include <h5intent/intent_pattern.h>
 #include <cpp-logger/logger.h>
+#include <mpi.h>
 
 
 #include <signal.h>
@@ -16,6 +19,10 @@
 #include <unistd.h>
 #include <regex>
 #include <iostream>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 #define INTENT_LOGGER cpplogger::Logger::Instance("H5INTENT")
 #define INTENT_LOGINFO(format, ...) \
   INTENT_LOGGER->log(cpplogger::LOG_INFO, format, __VA_ARGS__);
@@ -32,28 +39,239 @@
 
 using json = nlohmann::json;
 namespace h5intent {
-class ConfigurationManager {
+enum LoadMode : int; /* intent_reader.h */
+/**
+ * Immutable view of one loaded configuration. Once published its intents
+ * are never modified, so any number of threads can read it without
+ * synchronization. The intents live in a compiled image (mmap-ed or built
+ * from JSON) that is used in place; the tuned properties of every record
+ * are compiled when the snapshot is built, or with H5INTENT_TRANSLATE=lookup
+ * the first time the record is looked up, and kept from then on.
+ */
+class IntentSnapshot {
+  std::shared_ptr<const char> storage;
+ public:
+  const CompiledIntents image;
+ private:
+  /* properties computed at load or on first lookup, each record exactly once. */
+  std::unique_ptr<DatasetProperties[]> dataset_properties;
+  std::unique_ptr<FileProperties[]> file_properties;
+  std::unique_ptr<std::once_flag[]> dataset_ready;
+  std::unique_ptr<std::once_flag[]> file_ready;
+  /* record-indexed tables of finished properties, nullptr while computed on lookup. */
+  const DatasetProperties* dataset_table;
+  const FileProperties* file_table;
+  /* keys like rank_{rank}_test.h5, consulted only when no exact key matches. */
+  PatternMatcher dataset_patterns;
+  PatternMatcher file_patterns;
+  void build_patterns();
  public:
-  Intents intents;
-  ConfigurationManager():intents() {}
-  ConfigurationManager(const ConfigurationManager& other):intents(other.intents){}
-  ConfigurationManager(ConfigurationManager&& other):intents(other.intents){}
-  ConfigurationManager& operator=(const ConfigurationManager& other) {
-    this->intents = other.intents;
-    return *this;
+  IntentSnapshot(std::shared_ptr<const char> storage, size_t size);
+  /**
+   * Snapshot over properties that were already compiled elsewhere (e.g. by
+   * the node leader into shared memory). Both tables must stay valid as
+   * long as storage is alive.
+   */
+  IntentSnapshot(std::shared_ptr<const char> storage, size_t size,
+                 const DatasetProperties* dataset_table,
+                 const FileProperties* file_table);
+  IntentSnapshot(const IntentSnapshot& other) = delete;
+  IntentSnapshot& operator=(const IntentSnapshot& other) = delete;
+  size_t dataset_count() const { return image.dataset_count(); }
+  size_t file_count() const { return image.file_count(); }
+  /* properties of a record, computed by the active policy at load or on first use. */
+  const DatasetProperties* dataset(size_t index) const;
+  const FileProperties* file(size_t index) const;
+  /**
+   * Single probe into the prebuilt index.
+   * @return compiled properties or nullptr if there is no intent for the name.
+   */
+  const DatasetProperties* find_dataset(std::string_view dataset_name) const;
+  /* record of the intent behind find_dataset, or -1. */
+  int64_t dataset_index(std::string_view dataset_name) const;
+  const FileProperties* find_file(std::string_view filename) const;
+  /* a snapshot of the same image whose properties are computed afresh. */
+  std::shared_ptr<const IntentSnapshot> untranslated() const;
+};
+
+/* a configuration file as this rank sees it; equal versions need no load. */
+struct ConfigurationVersion {
+  std::string path; /* canonical, empty if nothing was loaded */
+  uint64_t device;
+  uint64_t inode;
+  uint64_t size;
+  int64_t mtime_ns;
+  ConfigurationVersion() : path(), device(0), inode(0), size(0), mtime_ns(0) {}
+  bool operator==(const ConfigurationVersion& other) const {
+    return path == other.path && device == other.device &&
+           inode == other.inode && size == other.size &&
+           mtime_ns == other.mtime_ns;
+  }
+  bool operator!=(const ConfigurationVersion& other) const {
+    return !(*this == other);
   }
-  void load_configuration(const std::string& configuration_file);
+};
 
+class ConfigurationManager {
+  /* readers only ever load this pointer; it is never taken under a lock. */
+  std::atomic<const IntentSnapshot*> current;
+  /* guards everything below; only writers (load, reload, reclaim) take it. */
+  std::mutex publish_mutex;
+  std::shared_ptr<const IntentSnapshot> current_owner;
+  /* replaced snapshots with the epoch they were retired at, freed by
+   * reclaim() once no reader can still be using them. */
+  std::vector<std::pair<uint64_t, std::shared_ptr<const IntentSnapshot>>>
+      retired;
+  /* serializes loads and reloads, which never run on the I/O path. */
+  std::mutex load_mutex;
+  /* version of the published snapshot, guarded by load_mutex. */
+  ConfigurationVersion loaded;
+  /* configuration waiting for a collective load, guarded by load_mutex. */
+  std::string pending;
+  /* set while pending is, so opens can skip the load without the lock. */
+  std::atomic<bool> deferred;
+  /* configuration last loaded collectively, as it was named. */
+  std::string collective_file;
+  /* dup of the first active communicator given to a collective load, used
+   * by every later one. Never freed: the manager outlives MPI_Finalize. */
+  MPI_Comm job_comm;
+  bool load_locked(const std::string& configuration_file, LoadMode mode,
+                   MPI_Comm comm);
+  void reclaim_locked();
+ public:
+  ConfigurationManager()
+      : current(nullptr),
+        publish_mutex(),
+        current_owner(),
+        retired(),
+        load_mutex(),
+        loaded(),
+        pending(),
+        deferred(false),
+        collective_file(),
+        job_comm(MPI_COMM_NULL) {}
+  ConfigurationManager(const ConfigurationManager& other) = delete;
+  ConfigurationManager& operator=(const ConfigurationManager& other) = delete;
+  /**
+   * Load and publish configuration_file unless the same version of it is
+   * already published, so repeated calls with one file only cost a stat.
+   * The collective load modes only remember the file here: this may run on
+   * some ranks only (HDF5 parses the connector string whenever it copies a
+   * FAPL), so their broadcast waits for load_configuration(comm). The file
+   * they loaded last is not remembered again.
+   * @return true if a new snapshot was published.
+   */
+  bool load_configuration(const std::string& configuration_file);
+  /**
+   * Load the configuration remembered by a collective load mode, once.
+   * comm has to span the job: the first active one is duplicated and every
+   * later collective load broadcasts over that copy, whatever comm it gets.
+   * Collective over it, so every rank has to get here, e.g. at its first
+   * H5Fcreate or H5Fopen. With MPI_COMM_NULL the file is read on this rank
+   * alone. Does nothing in the local mode or once the file is loaded;
+   * H5INTENT_RELOAD picks up later edits.
+   * @return true if a new snapshot was published.
+   */
+  bool load_configuration(MPI_Comm comm);
+  /* true if a collective load mode waits for load_configuration(comm). */
+  inline bool load_pending() const {
+    return deferred.load(std::memory_order_acquire);
+  }
+  /* canonical path of the published configuration, empty if none. */
+  std::string configuration_path();
+  /**
+   * Re-read the last loaded configuration on this rank and publish it. Safe
+   * from any thread; on failure the current snapshot stays. Never collective,
+   * whatever the load mode: the new snapshot is a private copy of this rank.
+   * @return true if a new snapshot was published.
+   */
+  bool reload_configuration();
+  /**
+   * Publish the current configuration again with no properties computed, so
+   * every intent is translated by the policy that is active now.
+   * @return false if nothing is loaded.
+   */
+  bool retranslate();
+  /* swap in snapshot; the replaced one is freed once its readers are done. */
+  void publish(std::shared_ptr<const IntentSnapshot> snapshot);
+  /* free retired snapshots that no reader can reach anymore. */
+  void reclaim();
+  /**
+   * Current snapshot or nullptr if nothing was loaded yet. Lock-free and
+   * allocation-free. Hold a ReadEpoch::Guard while using the pointer when
+   * another thread may publish; without one it is only valid until the next
+   * publish.
+   */
+  inline const IntentSnapshot* snapshot() const {
+    return current.load(std::memory_order_seq_cst);
+  }
 };
 }
+DatasetProperties to_dataset_properties(const DatasetIOIntents &intents);
+FileProperties to_file_properties(const FileIOIntents &intents);
 
 extern "C" {
 #endif
+#include <mpi.h>
 #include <signal.h>
 void load_configuration(const char* file);
+/**
+ * Load the configuration a collective H5INTENT_LOAD_MODE deferred, with the
+ * broadcast over a copy of comm, which has to span the job (see
+ * ConfigurationManager::load_configuration). Collective over comm;
+ * MPI_COMM_NULL reads it on this rank alone.
+ */
+void load_configuration_collective(MPI_Comm comm);
+/* true if a collective H5INTENT_LOAD_MODE still waits for the call above. */
+bool load_configuration_pending(void);
+/**
+ * Select a tuning policy (see PolicyRegistry::select) and translate the
+ * loaded configuration with it, so files and datasets opened from now on use
+ * it even if they were looked up before.
+ */
+bool select_policy(const char* name);
 char* fix_filename(char* file);
 bool get_dataset_properties(const char* dataset_name, struct DatasetProperties *properties);
 bool get_file_properties(const char* file, struct FileProperties* properties);
+/**
+ * Solve the chunk shape of a dataset being created, from its dataspace
+ * (rank, dims, max_dims), element size and the intent's dominant access.
+ * @return false if there is no intent for the dataset or it cannot be chunked.
+ */
+bool get_dataset_chunk(const char* dataset_name, const char* filename, int ndims,
+                       const hsize_t* dims, const hsize_t* max_dims,
+                       size_t element_size, hsize_t* chunk);
+/**
+ * Size the chunk cache of a dataset being created or opened for its chunk shape,
+ * keeping the chunks one access touches within the rank's memory budget.
+ * @return false if there is no intent for the dataset.
+ */
+bool get_dataset_chunk_cache(const char* dataset_name, const char* filename,
+                             int ndims, const hsize_t* dims,
+                             const hsize_t* max_dims, size_t element_size,
+                             const hsize_t* chunk, size_t* rdcc_nslots,
+                             size_t* rdcc_nbytes, double* rdcc_w0);
+/**
+ * Take bytes of the rank's core VFD memory budget for a file being opened.
+ * @return false if the files already open leave too little of it.
+ */
+bool reserve_core_memory(size_t bytes);
+/* give back a reservation when its file is closed. */
+void release_core_memory(size_t bytes);
+/* telemetry id of a dataset being opened or created, -1 if telemetry is off. */
+int register_dataset_telemetry(const char* dataset_name);
+/**
+ * Count one read or write of bytes on a dataset and the seconds it took, in
+ * the calling thread's table; takes no lock once the thread has seen the
+ * dataset. Ids below 0 are ignored.
+ */
+void record_dataset_io(int id, bool is_write, size_t bytes, bool contiguous,
+                       uint64_t nanoseconds);
+/* whether a selection of npoints bounded by [start, end] is one run in the file. */
+bool is_contiguous_selection(int ndims, const hsize_t* dims, const hsize_t* start,
+                             const hsize_t* end, hsize_t npoints);
+/* write the telemetry to the file H5INTENT_TELEMETRY names, suffixed by the rank. */
+bool dump_dataset_telemetry();
 bool select_correct_conf(const char* confs, char** selected_conf);
 void signal_handler(int sig);
 void set_signal();
@@ -0,0 +1,159 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "chunk_solver.h"
+
+#include <algorithm>
+
+namespace h5intent {
+static uint64_t smallest_factor(uint64_t value) {
+  for (uint64_t factor = 2; factor * factor <= value; ++factor)
+    if (value % factor == 0) return factor;
+  return value;
+}
+
+/* largest chunk extent along d, 0 if the dim does not bound the chunk. */
+static uint64_t chunk_bound(const ChunkConstraints& constraints, unsigned d) {
+  if (constraints.max_dims[d] == H5S_UNLIMITED) return 0;
+  return std::max(constraints.max_dims[d], constraints.dims[d]);
+}
+
+/* extent of one access along d; dims the segment does not describe are
+ * accessed whole. */
+static uint64_t access_length(const ChunkConstraints& constraints, unsigned d) {
+  const auto& segment = constraints.segment;
+  if (d < segment.ndims && segment.length[d] > 0) return segment.length[d];
+  return constraints.dims[d] > 0 ? constraints.dims[d] : 1;
+}
+
+/* accesses along d are adjacent, so a longer chunk only holds data that
+ * the next access needs anyway. */
+static bool contiguous_along(const ChunkConstraints& constraints, unsigned d) {
+  const auto& segment = constraints.segment;
+  return d >= segment.ndims || segment.stride[d] <= segment.length[d];
+}
+
+/* saturates instead of overflowing, anything past the HDF5 limit is invalid. */
+static uint64_t chunk_bytes(const ChunkConstraints& constraints,
+                            const hsize_t* chunk) {
+  uint64_t bytes = std::max<size_t>(constraints.element_size, 1);
+  for (unsigned d = 0; d < constraints.ndims; ++d) {
+    if (bytes > CHUNK_MAX_BYTES / chunk[d]) return CHUNK_MAX_BYTES + 1;
+    bytes *= chunk[d];
+  }
+  return bytes;
+}
+
+bool solve_chunk_shape(const ChunkConstraints& constraints, hsize_t* chunk) {
+  unsigned ndims = std::min<unsigned>(constraints.ndims, H5S_MAX_RANK);
+  if (ndims == 0) return false;
+  /* start from the access itself, clipped to the dataspace. */
+  for (unsigned d = 0; d < ndims; ++d) {
+    uint64_t bound = chunk_bound(constraints, d);
+    if (constraints.max_dims[d] != H5S_UNLIMITED && bound == 0) return false;
+    uint64_t length = access_length(constraints, d);
+    chunk[d] = bound > 0 ? std::min(length, bound) : length;
+  }
+  /* split the outermost dims first by their smallest factor, so the chunk
+   * still tiles the access and rows stay contiguous. */
+  uint64_t bytes = chunk_bytes(constraints, chunk);
+  for (unsigned d = 0; d < ndims && bytes > CHUNK_TARGET_MAX_BYTES;) {
+    if (chunk[d] == 1) {
+      ++d;
+      continue;
+    }
+    chunk[d] /= smallest_factor(chunk[d]);
+    bytes = chunk_bytes(constraints, chunk);
+  }
+  if (bytes > CHUNK_MAX_BYTES) return false;
+  /* grow chunks below a filesystem block by whole accesses, unless
+   * independent writers would then share a chunk. */
+  bool shared_writers = constraints.process_count > 1 &&
+                        constraints.sharing_pattern != COLLECTIVE;
+  uint64_t block = constraints.fs_block_size > 0 ? constraints.fs_block_size
+                                                 : DEFAULT_FS_BLOCK_SIZE;
+  for (unsigned d = 0; d < ndims && bytes < block && !shared_writers; ++d) {
+    if (!contiguous_along(constraints, d)) continue;
+    uint64_t bound = chunk_bound(constraints, d);
+    uint64_t multiple = (block + bytes - 1) / bytes;
+    uint64_t grown = chunk[d] * multiple;
+    if (bound > 0) grown = std::min(grown, bound);
+    chunk[d] = std::max<uint64_t>(chunk[d], grown);
+    bytes = chunk_bytes(constraints, chunk);
+  }
+  return true;
+}
+
+size_t segment_element_size(const AccessSegment& segment) {
+  uint64_t elements = 1;
+  for (unsigned d = 0; d < segment.ndims; ++d)
+    elements *= std::max<hsize_t>(segment.length[d], 1);
+  return std::max<uint64_t>(segment.access / elements, 1);
+}
+
+ChunkConstraints intent_constraints(const DatasetIOIntents& intents,
+                                    uint64_t fs_block_size) {
+  auto constraints = ChunkConstraints();
+  const auto& segment = intents.top_accessed_segments.segments[0];
+  constraints.ndims = (unsigned)std::min<size_t>(intents.ndims, H5S_MAX_RANK);
+  for (unsigned d = 0; d < constraints.ndims; ++d)
+    constraints.max_dims[d] = H5S_UNLIMITED;
+  constraints.element_size = segment_element_size(segment);
+  constraints.segment = segment;
+  constraints.sharing_pattern = intents.sharing_pattern;
+  constraints.process_count = intents.process_sharing.size();
+  constraints.fs_block_size = fs_block_size;
+  return constraints;
+}
+
+uint64_t chunks_per_access(const ChunkConstraints& constraints,
+                           const hsize_t* chunk) {
+  uint64_t chunks = 1;
+  for (unsigned d = 0; d < constraints.ndims; ++d) {
+    uint64_t length = access_length(constraints, d);
+    chunks *= (length + chunk[d] - 1) / chunk[d];
+  }
+  return chunks;
+}
+
+uint64_t chunks_per_unaligned_access(const ChunkConstraints& constraints,
+                                     const hsize_t* chunk) {
+  const auto& segment = constraints.segment;
+  uint64_t chunks = 1;
+  for (unsigned d = 0; d < constraints.ndims; ++d) {
+    uint64_t length = access_length(constraints, d);
+    uint64_t along = (length + chunk[d] - 1) / chunk[d];
+    /* an access starting inside a chunk spills into one more. */
+    if (d < segment.ndims && segment.stride[d] % chunk[d] != 0 && chunk[d] > 1) ++along;
+    chunks *= along;
+  }
+  return chunks;
+}
+
+size_t next_prime(size_t value) {
+  if (value <= 2) return 2;
+  for (value |= 1;; value += 2) {
+    bool prime = true;
+    for (size_t factor = 3; factor * factor <= value && prime; factor += 2)
+      prime = value % factor != 0;
+    if (prime) return value;
+  }
+}
+
+ChunkCachePlan plan_chunk_cache(const ChunkConstraints& constraints,
+                                const hsize_t* chunk, AccessPatternType type,
+                                uint64_t budget) {
+  ChunkCachePlan plan;
+  /* read-after-write revisits whole chunks, anything else is done with them. */
+  plan.w0 = type == AP_RAW ? 0 : type == AP_OTHER ? 0.75 : 1;
+  uint64_t limit = budget > 0 ? budget / CHUNK_CACHE_BUDGET_SHARE
+                              : CHUNK_CACHE_DEFAULT_BYTES;
+  uint64_t bytes = chunk_bytes(constraints, chunk);
+  uint64_t resident = chunks_per_unaligned_access(constraints, chunk);
+  uint64_t held = bytes > limit ? 0 : std::min(resident, limit / bytes);
+  plan.nbytes = held * bytes;
+  plan.nslots = next_prime(std::max<uint64_t>(held, 1) * CHUNK_CACHE_SLOTS_PER_CHUNK);
+  return plan;
+}
+}  // namespace h5intent
@@ -0,0 +1,94 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_CHUNK_SOLVER_H
+#define H5INTENT_CHUNK_SOLVER_H
+#include <h5intent/property_dds.h>
+
+#include <cstddef>
+#include <cstdint>
+/**
+ * Picks a chunk shape (in elements) for a dataset from its dataspace and its
+ * dominant access segment. The solver satisfies HDF5's constraints first
+ * (rank, 0 < chunk <= extent of fixed dims, < 4 GB per chunk) and then keeps
+ * the chunk aligned to the access: every dim is a divisor or a multiple of
+ * the segment length, so an aligned access touches whole chunks only.
+ */
+namespace h5intent {
+/* HDF5 stores chunk sizes in 32 bits. */
+static const uint64_t CHUNK_MAX_BYTES = (1ULL << 32) - 1;
+/* larger chunks are split, they only inflate the chunk cache. */
+static const uint64_t CHUNK_TARGET_MAX_BYTES = 64ULL * 1024 * 1024;
+static const uint64_t DEFAULT_FS_BLOCK_SIZE = 1024 * 1024;
+
+struct ChunkConstraints {
+  unsigned ndims;
+  /* current extent; 0 means not known (e.g. when intents are compiled). */
+  uint64_t dims[H5S_MAX_RANK];
+  /* H5S_UNLIMITED for extendible dims; a fixed dim bounds the chunk. */
+  uint64_t max_dims[H5S_MAX_RANK];
+  size_t element_size;
+  /* most common access, lengths in elements. */
+  AccessSegment segment;
+  SharingPattern sharing_pattern;
+  size_t process_count;
+  uint64_t fs_block_size;
+};
+
+/* a dataset's chunk cache may take this share of the rank's memory budget. */
+static const uint64_t CHUNK_CACHE_BUDGET_SHARE = 8;
+/* HDF5's default cache, used when the budget is not known. */
+static const uint64_t CHUNK_CACHE_DEFAULT_BYTES = 1024 * 1024;
+/* hash slots per cached chunk, HDF5 suggests about 100 to avoid collisions. */
+static const size_t CHUNK_CACHE_SLOTS_PER_CHUNK = 100;
+
+struct ChunkCachePlan {
+  size_t nslots; /* prime */
+  size_t nbytes;
+  double w0;
+};
+
+/* bytes per element of segment, 1 if its size in bytes is not recorded. */
+size_t segment_element_size(const AccessSegment& segment);
+
+/**
+ * Constraints for translating intents, before the dataspace is known: every
+ * dim extendible and the element size taken from the dominant segment.
+ */
+ChunkConstraints intent_constraints(const DatasetIOIntents& intents,
+                                    uint64_t fs_block_size);
+
+/**
+ * @return false if the dataset cannot be chunked (rank 0 or a fixed dim of
+ * extent 0), otherwise true with ndims entries written to chunk.
+ */
+bool solve_chunk_shape(const ChunkConstraints& constraints, hsize_t* chunk);
+
+/**
+ * Chunks touched by one access of the segment aligned to its own length,
+ * the quantity the solver keeps small.
+ */
+uint64_t chunks_per_access(const ChunkConstraints& constraints,
+                           const hsize_t* chunk);
+
+/* chunks one access touches when accesses do not start on chunk boundaries,
+ * i.e. when the stride is not a multiple of the chunk. */
+uint64_t chunks_per_unaligned_access(const ChunkConstraints& constraints,
+                                     const hsize_t* chunk);
+
+/**
+ * Chunk cache that keeps the chunks one access touches resident, capped at
+ * 1/CHUNK_CACHE_BUDGET_SHARE of budget; if not even one chunk fits, the
+ * cache is disabled and chunks go straight to the file. w0 evicts fully
+ * accessed chunks first for write-once and read-once datasets, and keeps
+ * them for read-after-write ones.
+ */
+ChunkCachePlan plan_chunk_cache(const ChunkConstraints& constraints,
+                                const hsize_t* chunk, AccessPatternType type,
+                                uint64_t budget);
+
+/* smallest prime >= value. */
+size_t next_prime(size_t value);
+}  // namespace h5intent
+#endif  // H5INTENT_CHUNK_SOLVER_H
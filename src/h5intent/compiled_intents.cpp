@@ -0,0 +1,346 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "compiled_intents.h"
+
+#include <fcntl.h>
+#include <h5intent/configuration_loader.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace h5intent {
+static size_t align8(size_t value) { return (value + 7) & ~size_t(7); }
+
+template <typename Map>
+static uint64_t find_or_zero(const Map& map, const std::string& key) {
+  auto iter = map.find(key);
+  return iter == map.end() ? 0 : iter->second;
+}
+
+StringRef IntentImageBuilder::add_string(const std::string& value) {
+  StringRef ref = {strings.size(), (uint32_t)value.size(), 0,
+                   intent_hash(value)};
+  strings.append(value);
+  return ref;
+}
+
+StringRef IntentImageBuilder::intern(const std::string& value) {
+  auto iter = interned.find(value);
+  if (iter != interned.end()) return iter->second;
+  return interned.emplace(value, add_string(value)).first->second;
+}
+
+RankRef IntentImageBuilder::add_ranks(const RankSet& process_sharing) {
+  auto runs = process_sharing.ranges();
+  RankRef ref = {ranks.size(), runs.size(), process_sharing.size()};
+  for (const auto& run : runs) ranks.push_back({run.first, run.second});
+  return ref;
+}
+
+void IntentImageBuilder::add_dataset(const std::string& name,
+                                     const DatasetIOIntents& intent) {
+  DatasetRecord record;
+  memset(&record, 0, sizeof(record));
+  record.name = add_string(name);
+  record.filename = intern(intent.filename);
+  record.ndims = (uint32_t)intent.ndims;
+  record.type = intent.type;
+  record.sharing_pattern = intent.sharing_pattern;
+  record.mode = intent.mode;
+  record.fs_size = intent.fs_size;
+  for (uint32_t s = 0; s < COMPILED_TOP_SEGMENTS; ++s) {
+    record.transfer_size[s] =
+        find_or_zero(intent.transfer_size_dist, std::to_string(s + 1));
+    const auto& segment = intent.top_accessed_segments.segments[s];
+    auto& target = record.segments[s];
+    target.ndims = segment.ndims;
+    for (uint32_t d = 0; d < segment.ndims; ++d) {
+      target.length[d] = segment.length[d];
+      target.stride[d] = segment.stride[d];
+    }
+    target.count = segment.count;
+    target.access = segment.access;
+  }
+  record.process_sharing = add_ranks(intent.process_sharing);
+  datasets.push_back(record);
+}
+
+void IntentImageBuilder::add_file(const std::string& filename,
+                                  const FileIOIntents& intent) {
+  FileRecord record;
+  memset(&record, 0, sizeof(record));
+  record.filename = intern(filename);
+  record.mode = intent.mode;
+  record.sharing_pattern = intent.sharing_pattern;
+  record.fs_size = intent.fs_size;
+  for (int i = 0; i < 4; ++i) {
+    record.ap_distribution[i] =
+        find_or_zero(intent.ap_distribution, std::to_string(i));
+    auto dist = intent.transfer_size_dist.find(std::to_string(i + 1));
+    if (dist != intent.transfer_size_dist.end()) {
+      record.transfer_size_sum[i] = find_or_zero(dist->second, "sum");
+      record.transfer_size_count[i] = find_or_zero(dist->second, "count");
+    }
+  }
+  record.ds_size_sum = find_or_zero(intent.ds_size_dist, "sum");
+  record.ds_size_count = find_or_zero(intent.ds_size_dist, "count");
+  record.group_count = intent.group_count;
+  record.process_sharing = add_ranks(intent.process_sharing);
+  files.push_back(record);
+}
+
+template <typename Record>
+static std::vector<IndexSlot> build_index(const std::vector<Record>& records,
+                                          const StringRef Record::*name) {
+  size_t slots = 1;
+  while (slots < records.size() * 2) slots <<= 1;
+  std::vector<IndexSlot> index(slots, IndexSlot{0, 0, 0, 0});
+  for (size_t i = 0; i < records.size(); ++i) {
+    const StringRef& ref = records[i].*name;
+    size_t slot = ref.hash & (slots - 1);
+    while (index[slot].record != 0) slot = (slot + 1) & (slots - 1);
+    index[slot] = IndexSlot{ref.hash, ref.offset, ref.length, (uint32_t)(i + 1)};
+  }
+  return index;
+}
+
+std::vector<char> IntentImageBuilder::finish() {
+  auto dataset_index = build_index(datasets, &DatasetRecord::name);
+  auto file_index = build_index(files, &FileRecord::filename);
+
+  CompiledHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, COMPILED_INTENT_MAGIC, sizeof(header.magic));
+  header.version = COMPILED_INTENT_VERSION;
+  header.endian = COMPILED_INTENT_ENDIAN;
+  size_t offset = align8(sizeof(CompiledHeader));
+  header.dataset_offset = offset;
+  header.dataset_count = datasets.size();
+  offset = align8(offset + datasets.size() * sizeof(DatasetRecord));
+  header.file_offset = offset;
+  header.file_count = files.size();
+  offset = align8(offset + files.size() * sizeof(FileRecord));
+  header.rank_offset = offset;
+  header.rank_count = ranks.size();
+  offset = align8(offset + ranks.size() * sizeof(RankRange));
+  header.dataset_index_offset = offset;
+  header.dataset_slots = dataset_index.size();
+  offset = align8(offset + dataset_index.size() * sizeof(IndexSlot));
+  header.file_index_offset = offset;
+  header.file_slots = file_index.size();
+  offset = align8(offset + file_index.size() * sizeof(IndexSlot));
+  header.string_offset = offset;
+  header.string_size = strings.size();
+  offset = align8(offset + strings.size());
+
+  std::vector<char> image(offset, 0);
+  auto copy = [&image](uint64_t at, const void* from, size_t bytes) {
+    if (bytes > 0) memcpy(image.data() + at, from, bytes);
+  };
+  copy(0, &header, sizeof(header));
+  copy(header.dataset_offset, datasets.data(),
+       datasets.size() * sizeof(DatasetRecord));
+  copy(header.file_offset, files.data(), files.size() * sizeof(FileRecord));
+  copy(header.rank_offset, ranks.data(), ranks.size() * sizeof(RankRange));
+  copy(header.dataset_index_offset, dataset_index.data(),
+       dataset_index.size() * sizeof(IndexSlot));
+  copy(header.file_index_offset, file_index.data(),
+       file_index.size() * sizeof(IndexSlot));
+  copy(header.string_offset, strings.data(), strings.size());
+  *this = IntentImageBuilder();
+  return image;
+}
+
+std::vector<char> compile_intents(const Intents& intents) {
+  IntentImageBuilder builder;
+  for (const auto& item : intents.datasets)
+    builder.add_dataset(item.first, item.second);
+  for (const auto& item : intents.files) builder.add_file(item.first, item.second);
+  return builder.finish();
+}
+
+bool CompiledIntents::is_compiled(const char* data, size_t size) {
+  return size >= sizeof(COMPILED_INTENT_MAGIC) &&
+         memcmp(data, COMPILED_INTENT_MAGIC, sizeof(COMPILED_INTENT_MAGIC)) == 0;
+}
+
+CompiledIntents::CompiledIntents(const char* data, size_t size)
+    : data(data), size(size), header((const CompiledHeader*)data) {
+  if (size < sizeof(CompiledHeader) || !is_compiled(data, size))
+    throw std::runtime_error("not a compiled intent image");
+  if (header->endian != COMPILED_INTENT_ENDIAN)
+    throw std::runtime_error("compiled intent image has foreign endianness");
+  if (header->version != COMPILED_INTENT_VERSION)
+    throw std::runtime_error("unsupported compiled intent image version " +
+                             std::to_string(header->version));
+  auto check = [size](uint64_t offset, uint64_t count, size_t element) {
+    if (offset > size || count > (size - offset) / element || offset % 8 != 0)
+      throw std::runtime_error("compiled intent image is truncated");
+  };
+  check(header->dataset_offset, header->dataset_count, sizeof(DatasetRecord));
+  check(header->file_offset, header->file_count, sizeof(FileRecord));
+  check(header->rank_offset, header->rank_count, sizeof(RankRange));
+  check(header->dataset_index_offset, header->dataset_slots, sizeof(IndexSlot));
+  check(header->file_index_offset, header->file_slots, sizeof(IndexSlot));
+  check(header->string_offset, header->string_size, 1);
+  /* images are mapped and shared as they are, so everything a lookup or
+   * to_intents follows is checked here once. */
+  for (uint64_t i = 0; i < header->dataset_count; ++i) {
+    const auto& record = dataset(i);
+    check_string(record.name);
+    check_string(record.filename);
+    check_ranks(record.process_sharing);
+  }
+  for (uint64_t i = 0; i < header->file_count; ++i) {
+    check_string(file(i).filename);
+    check_ranks(file(i).process_sharing);
+  }
+  check_index((const IndexSlot*)(data + header->dataset_index_offset),
+              header->dataset_slots, header->dataset_count);
+  check_index((const IndexSlot*)(data + header->file_index_offset),
+              header->file_slots, header->file_count);
+}
+
+void CompiledIntents::check_string(uint64_t offset, uint64_t length) const {
+  if (offset > header->string_size || length > header->string_size - offset)
+    throw std::runtime_error("compiled intent image has a string out of bounds");
+}
+
+void CompiledIntents::check_ranks(const RankRef& ref) const {
+  if (ref.offset > header->rank_count ||
+      ref.range_count > header->rank_count - ref.offset)
+    throw std::runtime_error("compiled intent image has ranks out of bounds");
+  auto runs = ranks(ref);
+  for (uint64_t i = 0; i < ref.range_count; ++i)
+    if (runs[i].first > runs[i].last)
+      throw std::runtime_error("compiled intent image has an empty rank range");
+}
+
+void CompiledIntents::check_index(const IndexSlot* index, uint64_t slots,
+                                  uint64_t records) const {
+  /* probes mask the hash with slots - 1. */
+  if ((slots & (slots - 1)) != 0 || (records > 0 && slots == 0))
+    throw std::runtime_error("compiled intent image index is not a power of two");
+  for (uint64_t slot = 0; slot < slots; ++slot) {
+    if (index[slot].record == 0) continue;
+    if (index[slot].record > records)
+      throw std::runtime_error("compiled intent image index points past its records");
+    check_string(index[slot].name_offset, index[slot].name_length);
+  }
+}
+
+const DatasetRecord& CompiledIntents::dataset(size_t index) const {
+  return ((const DatasetRecord*)(data + header->dataset_offset))[index];
+}
+
+const FileRecord& CompiledIntents::file(size_t index) const {
+  return ((const FileRecord*)(data + header->file_offset))[index];
+}
+
+const RankRange* CompiledIntents::ranks(const RankRef& ref) const {
+  return (const RankRange*)(data + header->rank_offset) + ref.offset;
+}
+
+static RankSet to_rank_set(const RankRange* runs, const RankRef& ref) {
+  RankSet ranks;
+  for (uint64_t i = 0; i < ref.range_count; ++i)
+    ranks.add_range(runs[i].first, runs[i].last);
+  return ranks;
+}
+
+static int64_t probe(const IndexSlot* index, uint64_t slots, const char* strings,
+                     std::string_view key) {
+  if (slots == 0) return -1;
+  uint64_t hash = intent_hash(key);
+  uint64_t slot = hash & (slots - 1);
+  /* a full index has no empty slot to stop at. */
+  for (uint64_t probed = 0; probed < slots; ++probed, slot = (slot + 1) & (slots - 1)) {
+    const IndexSlot& entry = index[slot];
+    if (entry.record == 0) return -1;
+    if (entry.hash == hash && entry.name_length == key.size() &&
+        memcmp(strings + entry.name_offset, key.data(), key.size()) == 0)
+      return entry.record - 1;
+  }
+  return -1;
+}
+
+int64_t CompiledIntents::find_dataset(std::string_view name) const {
+  return probe((const IndexSlot*)(data + header->dataset_index_offset),
+               header->dataset_slots, data + header->string_offset, name);
+}
+
+int64_t CompiledIntents::find_file(std::string_view filename) const {
+  return probe((const IndexSlot*)(data + header->file_index_offset),
+               header->file_slots, data + header->string_offset, filename);
+}
+
+DatasetIOIntents CompiledIntents::to_intents(const DatasetRecord& record) const {
+  DatasetIOIntents intents{};
+  intents.dataset_name = std::string(str(record.name));
+  intents.filename = std::string(str(record.filename));
+  intents.ndims = record.ndims;
+  intents.type = (AccessPatternType)record.type;
+  intents.sharing_pattern = (SharingPattern)record.sharing_pattern;
+  intents.mode = (FileMode)record.mode;
+  intents.fs_size = record.fs_size;
+  for (uint32_t s = 0; s < COMPILED_TOP_SEGMENTS; ++s) {
+    intents.transfer_size_dist[std::to_string(s + 1)] = record.transfer_size[s];
+    const auto& segment = record.segments[s];
+    auto& target = intents.top_accessed_segments.segments[s];
+    target.ndims = (unsigned)std::min<uint64_t>(segment.ndims, COMPILED_MAX_DIMS);
+    for (uint32_t d = 0; d < target.ndims; ++d) {
+      target.length[d] = segment.length[d];
+      target.stride[d] = segment.stride[d];
+    }
+    target.count = segment.count;
+    target.access = segment.access;
+  }
+  intents.process_sharing =
+      to_rank_set(ranks(record.process_sharing), record.process_sharing);
+  return intents;
+}
+
+FileIOIntents CompiledIntents::to_intents(const FileRecord& record) const {
+  FileIOIntents intents{};
+  intents.filename = std::string(str(record.filename));
+  intents.mode = (FileMode)record.mode;
+  intents.sharing_pattern = (SharingPattern)record.sharing_pattern;
+  intents.fs_size = record.fs_size;
+  for (int i = 0; i < 4; ++i) {
+    intents.ap_distribution[std::to_string(i)] = record.ap_distribution[i];
+    auto& dist = intents.transfer_size_dist[std::to_string(i + 1)];
+    dist["sum"] = record.transfer_size_sum[i];
+    dist["count"] = record.transfer_size_count[i];
+  }
+  intents.ds_size_dist["sum"] = record.ds_size_sum;
+  intents.ds_size_dist["count"] = record.ds_size_count;
+  intents.group_count = record.group_count;
+  intents.process_sharing =
+      to_rank_set(ranks(record.process_sharing), record.process_sharing);
+  return intents;
+}
+
+std::shared_ptr<const char> map_file(const std::string& path, size_t& size) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return nullptr;
+  }
+  size = st.st_size;
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) return nullptr;
+  size_t length = size;
+  return std::shared_ptr<const char>(
+      (const char*)mapped,
+      [length](const char* ptr) { munmap((void*)ptr, length); });
+}
+}  // namespace h5intent
@@ -0,0 +1,216 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_COMPILED_INTENTS_H
+#define H5INTENT_COMPILED_INTENTS_H
+#include <h5intent/property_dds.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+/**
+ * Binary form of the intents that can be mmap-ed and used in place.
+ *
+ * Layout (all sections 8-byte aligned, native endianness):
+ *    CompiledHeader
+ *    DatasetRecord[dataset_count]
+ *    FileRecord[file_count]
+ *    RankRange ranks[rank_count]            process_sharing runs of all records
+ *    IndexSlot dataset_index[dataset_slots] open addressing, linear probing
+ *    IndexSlot file_index[file_slots]
+ *    char strings[string_table_size]        names, not null terminated
+ */
+namespace h5intent {
+static const char COMPILED_INTENT_MAGIC[8] = {'H', '5', 'I', 'N',
+                                              'T', 'B', 'I', 'N'};
+static const uint32_t COMPILED_INTENT_VERSION = 5;
+static const uint32_t COMPILED_INTENT_ENDIAN = 0x01020304;
+static const uint32_t COMPILED_MAX_DIMS = SEGMENT_MAX_DIMS;
+static const uint32_t COMPILED_TOP_SEGMENTS = TOP_ACCESSED_SEGMENTS;
+
+struct CompiledHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t endian;
+  uint64_t dataset_offset;
+  uint64_t dataset_count;
+  uint64_t file_offset;
+  uint64_t file_count;
+  uint64_t rank_offset;
+  uint64_t rank_count;
+  uint64_t dataset_index_offset;
+  uint64_t dataset_slots;
+  uint64_t file_index_offset;
+  uint64_t file_slots;
+  uint64_t string_offset;
+  uint64_t string_size;
+};
+
+struct StringRef {
+  uint64_t offset;
+  uint32_t length;
+  uint32_t reserved;
+  uint64_t hash;
+};
+
+/* a probe reads the slot and the name, never the record itself. */
+struct IndexSlot {
+  uint64_t hash;
+  uint64_t name_offset; /* into the string table */
+  uint32_t name_length;
+  uint32_t record; /* record + 1, 0 for an empty slot */
+};
+
+struct RankRange {
+  uint32_t first;
+  uint32_t last;
+};
+
+struct RankRef {
+  uint64_t offset;
+  uint64_t range_count;
+  uint64_t cardinality;
+};
+
+struct SegmentRecord {
+  uint64_t ndims;
+  uint64_t length[COMPILED_MAX_DIMS];
+  uint64_t stride[COMPILED_MAX_DIMS];
+  uint64_t count;
+  uint64_t access;
+};
+
+struct DatasetRecord {
+  StringRef name;
+  StringRef filename;
+  uint32_t ndims;
+  uint32_t type;
+  uint32_t sharing_pattern;
+  uint32_t mode;
+  uint64_t fs_size;
+  uint64_t transfer_size[COMPILED_TOP_SEGMENTS];
+  SegmentRecord segments[COMPILED_TOP_SEGMENTS];
+  RankRef process_sharing;
+};
+
+struct FileRecord {
+  StringRef filename;
+  uint32_t mode;
+  uint32_t sharing_pattern;
+  uint64_t fs_size;
+  uint64_t ap_distribution[4];
+  uint64_t transfer_size_sum[4];
+  uint64_t transfer_size_count[4];
+  uint64_t ds_size_sum;
+  uint64_t ds_size_count;
+  uint64_t group_count;
+  RankRef process_sharing;
+};
+
+/**
+ * Hash used both when building and when probing the index. Consumes eight
+ * bytes per multiply, since dataset keys (file:/group/dataset) are often
+ * longer than 100 bytes.
+ */
+inline uint64_t intent_hash(std::string_view key) {
+  const uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+  uint64_t hash = key.size() * multiplier;
+  size_t offset = 0;
+  uint64_t word;
+  for (; offset + sizeof(word) <= key.size(); offset += sizeof(word)) {
+    memcpy(&word, key.data() + offset, sizeof(word));
+    hash = (hash ^ word) * multiplier;
+    hash ^= hash >> 32;
+  }
+  word = 0;
+  memcpy(&word, key.data() + offset, key.size() - offset);
+  hash = (hash ^ word) * multiplier;
+  return hash ^ (hash >> 29);
+}
+
+/**
+ * Builds a compiled image one entry at a time, so intents can be compiled
+ * while they are parsed without keeping all of them around.
+ */
+class IntentImageBuilder {
+  std::vector<DatasetRecord> datasets;
+  std::vector<FileRecord> files;
+  std::vector<RankRange> ranks;
+  std::string strings;
+  /* filenames repeat in every dataset record, so they are stored once. */
+  std::unordered_map<std::string, StringRef> interned;
+
+  StringRef add_string(const std::string& value);
+  StringRef intern(const std::string& value);
+  RankRef add_ranks(const RankSet& process_sharing);
+
+ public:
+  void add_dataset(const std::string& name, const DatasetIOIntents& intent);
+  void add_file(const std::string& filename, const FileIOIntents& intent);
+  size_t dataset_count() const { return datasets.size(); }
+  size_t file_count() const { return files.size(); }
+  /* lay out the image; the builder is empty afterwards. */
+  std::vector<char> finish();
+};
+
+/**
+ * Serialize intents into a compiled image.
+ */
+std::vector<char> compile_intents(const Intents& intents);
+
+/**
+ * Read-only view over a compiled image. The view does not own the memory;
+ * the caller keeps the mapping or buffer alive.
+ */
+class CompiledIntents {
+  const char* data;
+  size_t size;
+  const CompiledHeader* header;
+  void check_string(uint64_t offset, uint64_t length) const;
+  void check_string(const StringRef& ref) const { check_string(ref.offset, ref.length); }
+  void check_ranks(const RankRef& ref) const;
+  void check_index(const IndexSlot* index, uint64_t slots, uint64_t records) const;
+
+ public:
+  /* true if the buffer starts with the compiled image magic. */
+  static bool is_compiled(const char* data, size_t size);
+  /**
+   * Validates the header, section bounds, every string and rank reference
+   * of the records and the index slots.
+   * @throws std::runtime_error if any of them falls outside the image.
+   */
+  CompiledIntents(const char* data, size_t size);
+
+  size_t dataset_count() const { return header->dataset_count; }
+  size_t file_count() const { return header->file_count; }
+  size_t image_size() const { return size; }
+  const DatasetRecord& dataset(size_t index) const;
+  const FileRecord& file(size_t index) const;
+  std::string_view str(const StringRef& ref) const {
+    return std::string_view(data + header->string_offset + ref.offset,
+                            ref.length);
+  }
+  const RankRange* ranks(const RankRef& ref) const;
+  /**
+   * Probe the prebuilt index.
+   * @return record index or -1 if the name is not in the image.
+   */
+  int64_t find_dataset(std::string_view name) const;
+  int64_t find_file(std::string_view filename) const;
+
+  DatasetIOIntents to_intents(const DatasetRecord& record) const;
+  FileIOIntents to_intents(const FileRecord& record) const;
+};
+
+/**
+ * Map a file read-only into memory.
+ * @return mapping that is unmapped when the last owner goes away, or nullptr.
+ */
+std::shared_ptr<const char> map_file(const std::string& path, size_t& size);
+}  // namespace h5intent
+#endif  // H5INTENT_COMPILED_INTENTS_H
@@ -4,9 +4,21 @@
 
 #include <h5intent/configuration_loader.h>
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include "property_dds.h"
 #include "singleton.h"
+#include "compiled_intents.h"
+#include "intent_reader.h"
+#include "shared_store.h"
+#include "read_epoch.h"
+#include "intent_reloader.h"
+#include "chunk_solver.h"
+#include "filesystem_info.h"
+#include "memory_budget.h"
+#include "tuning_policy.h"
+#include "dataset_telemetry.h"
 #include <filesystem>
 #define GB 1024L*1024L*1024L
 #define MB 1024L*1024L
@@ -57,6 +69,7 @@ extern void signal_handler(int sig){
     switch(sig) {
         case SIGHUP:{
             INTENT_LOGPRINT("hangup signal caught",0);
+            h5intent::IntentReloader::request();
             break;
         }
         case SIGTERM:{
@@ -137,126 +150,354 @@ extern void set_signal() {
     sigaction(SIGHUP, &sa, NULL);
     sigaction(SIGTERM, &sa, NULL);
 }
+/* watch a configuration that was just published, if H5INTENT_RELOAD asks to. */
+static void start_reloader(h5intent::ConfigurationManager* manager,
+                           const std::string& file) {
+  auto mode = h5intent::reload_mode_from_env();
+  if (mode != h5intent::RELOAD_OFF)
+    h5intent::Singleton<h5intent::IntentReloader>::get_instance()->start(
+        manager, file, mode);
+}
 extern void load_configuration(const char* file) {
-  h5intent::Singleton<h5intent::ConfigurationManager>::get_instance()->load_configuration(
-      file);
+  try {
+    auto manager = h5intent::Singleton<h5intent::ConfigurationManager>::get_instance();
+    /* HDF5 parses the connector string again whenever it copies a FAPL. */
+    if (!manager->load_configuration(file)) return;
+    start_reloader(manager, file);
+  } catch (const std::exception& e) {
+    INTENT_LOGERROR("loading conf %s failed: %s", file, e.what());
+  }
+}
+extern void load_configuration_collective(MPI_Comm comm) {
+  try {
+    auto manager = h5intent::Singleton<h5intent::ConfigurationManager>::get_instance();
+    if (!manager->load_configuration(comm)) return;
+    start_reloader(manager, manager->configuration_path());
+  } catch (const std::exception& e) {
+    INTENT_LOGERROR("loading conf collectively failed: %s", e.what());
+  }
+}
+extern bool load_configuration_pending(void) {
+  return h5intent::Singleton<h5intent::ConfigurationManager>::get_instance()
+      ->load_pending();
+}
+extern bool select_policy(const char* name) {
+  if (!h5intent::Singleton<h5intent::PolicyRegistry>::get_instance()->select(name))
+    return false;
+  h5intent::Singleton<h5intent::ConfigurationManager>::get_instance()->retranslate();
+  return true;
 }
 extern char* fix_filename(char* filename) {
     std::filesystem::path posix_path{filename};
     strcpy(filename, posix_path.generic_string().c_str());
     return filename;
 }
-void h5intent::ConfigurationManager::                                                                                                                                                                                                                                                                                                                         load_configuration(
+bool h5intent::ConfigurationManager::load_configuration(
     const std::string& configuration_file) {
-  std::ifstream t(configuration_file);
-  t.seekg(0, std::ios::end);
-  size_t size = t.tellg();
-  std::string buffer(size, ' ');
-  t.seekg(0);
-  t.read(&buffer[0], size);
-  t.close();
-  json read_json = json::parse(buffer);
-  read_json.get_to(intents);
-
-  INTENT_LOGINFO("# of datasets %d, # of files %d, from conf %s", intents.datasets.size(),
-         intents.files.size(),
+  auto mode = load_mode_from_env();
+  std::lock_guard<std::mutex> lock(load_mutex);
+  if (mode != LOAD_LOCAL) {
+    if (configuration_file != collective_file) {
+      pending = configuration_file;
+      deferred.store(true, std::memory_order_release);
+    }
+    return false;
+  }
+  return load_locked(configuration_file, mode, MPI_COMM_NULL);
+}
+bool h5intent::ConfigurationManager::load_configuration(MPI_Comm comm) {
+  auto mode = load_mode_from_env();
+  std::lock_guard<std::mutex> lock(load_mutex);
+  if (mode == LOAD_LOCAL || pending.empty()) return false;
+  bool collective = active_communicator(comm);
+  /* files may be opened over MPI_COMM_SELF, the broadcast has to span the job. */
+  if (collective && job_comm == MPI_COMM_NULL) MPI_Comm_dup(comm, &job_comm);
+  /* attempted once either way, so later opens do no MPI work. */
+  collective_file = std::move(pending);
+  pending.clear();
+  deferred.store(false, std::memory_order_release);
+  return load_locked(collective_file, mode, collective ? job_comm : MPI_COMM_NULL);
+}
+std::string h5intent::ConfigurationManager::configuration_path() {
+  std::lock_guard<std::mutex> lock(load_mutex);
+  return loaded.path;
+}
+bool h5intent::ConfigurationManager::load_locked(
+    const std::string& configuration_file, LoadMode mode, MPI_Comm comm) {
+  auto version = configuration_version(configuration_file, comm);
+  int changed = version != loaded;
+  /* a reload after SIGHUP may have moved some ranks on already. */
+  if (active_communicator(comm))
+    MPI_Allreduce(MPI_IN_PLACE, &changed, 1, MPI_INT, MPI_LOR, comm);
+  if (!changed) return false;
+  std::shared_ptr<const IntentSnapshot> snapshot;
+  if (mode == LOAD_SHARED) {
+    snapshot = load_shared_snapshot(configuration_file, comm);
+  } else {
+    size_t size = 0;
+    auto storage = read_intent_image(configuration_file, size, mode, comm);
+    if (storage != nullptr)
+      snapshot = std::make_shared<const IntentSnapshot>(storage, size);
+  }
+  if (snapshot == nullptr) return false;
+  INTENT_LOGINFO("# of datasets %d, # of files %d, from conf %s", snapshot->dataset_count(),
+         snapshot->file_count(),
          configuration_file.c_str());
+  publish(std::move(snapshot));
+  loaded = std::move(version);
+  return true;
 }
-DatasetProperties to_dataset_properties(DatasetIOIntents &intents) {
-    const int PPN=40;
-    auto properties = DatasetProperties();
-    bool enable_chunking = true;
-    auto most_common_ts = intents.transfer_size_dist.find("1")->second;
-    auto most_common_segments = intents.top_accessed_segments.find("1")->second;
-    size_t ndims = intents.ndims;
-    auto chunks = std::vector<size_t>(ndims);
-    auto lengths_any = most_common_segments.find("length")->second;
-    auto lengths = std::vector<int>(ndims);
-    if (lengths_any.type() == typeid(std::vector<int>)) {
-        lengths = std::any_cast<std::vector<int>>(lengths_any);
-    }
-    for(int d=0;d<ndims;++d) chunks[d] = lengths[d];
-    if(intents.process_sharing.size() > 1) {
-        if (most_common_ts > 32 * MB) {
-            enable_chunking = false;
-        } else if (most_common_ts * intents.process_sharing.size() > 16*MB) {
-            chunks[0] = 16 * MB;
-            for(int d  = 1; d < ndims; ++d) {
-                chunks[d] = 1;
-            }
-        }else {
-            chunks[0] = most_common_ts;
-            for(int d  = 1; d < ndims; ++d) {
-                chunks[d] = 1;
-            }
-        }
-    } else {
-      if (most_common_ts > 32 * MB) {
-        enable_chunking = false; 
-      } else {
-        chunks[0] = 32 * MB;
-        for(int d  = 1; d < ndims; ++d) {
-           chunks[d] = 1;
-        }
-      }
-
-    }
-    float rdcc_w0 = 0;
-    if (intents.mode == FILE_WRITE_ONLY || intents.mode == FILE_READ_ONLY)
-        rdcc_w0 = 1;
-
-    properties.access.chunk_cache = {
-            enable_chunking, intents.fs_size / intents.process_sharing.size() * most_common_ts, intents.fs_size, rdcc_w0
-    };
-    INTENT_LOGINFO("Chunk cache for dataset %s has size %d", intents.dataset_name.c_str(), properties.access.chunk_cache.rdcc_nbytes)
-    properties.access.chunk = {
-            enable_chunking, (int)ndims, chunks.data(),
-    };
-    INTENT_LOGINFO("Chunk for dataset %s has size %d", intents.dataset_name.c_str(), chunks[0])
-    if (intents.process_sharing.size() == 1) {
-        properties.transfer.dmpiio.use = false;
-    } else {
-        properties.transfer.dmpiio.use = true;
-        properties.transfer.dmpiio.xfer_mode = H5FD_MPIO_COLLECTIVE;
-        properties.transfer.dmpiio.coll_opt_mode = H5FD_MPIO_COLLECTIVE_IO;
-        properties.transfer.dmpiio.chunk_opt_mode = H5FD_MPIO_CHUNK_ONE_IO;
-        properties.transfer.dmpiio.num_chunk_per_proc = 64;
-        properties.transfer.dmpiio.percent_num_proc_per_chunk = 1/intents.process_sharing.size()*100;
-    }
-    return properties;
+bool h5intent::ConfigurationManager::reload_configuration() {
+  std::lock_guard<std::mutex> lock(load_mutex);
+  if (loaded.path.empty()) return false;
+  /* not collective: a reload may run on one rank only, e.g. after SIGHUP,
+   * and ranks see a watched file change a different number of times. */
+  auto mode = load_mode_from_env();
+  if (mode != LOAD_LOCAL)
+    INTENT_LOGWARN("reloading conf %s on this rank alone, H5INTENT_LOAD_MODE "
+                   "only applies to the first load%s", loaded.path.c_str(),
+                   mode == LOAD_SHARED ? "; this rank stops sharing its node's copy" : "")
+  auto version = configuration_version(loaded.path, MPI_COMM_NULL);
+  std::shared_ptr<const IntentSnapshot> snapshot;
+  try {
+    size_t size = 0;
+    auto storage = read_intent_image(loaded.path, size, LOAD_LOCAL, MPI_COMM_NULL);
+    if (storage != nullptr)
+      snapshot = std::make_shared<const IntentSnapshot>(storage, size);
+  } catch (const std::exception& e) {
+    INTENT_LOGERROR("reloading conf %s failed: %s", loaded.path.c_str(), e.what());
+  }
+  if (snapshot == nullptr) return false;
+  INTENT_LOGINFO("reloaded %d datasets, %d files from conf %s",
+                 snapshot->dataset_count(), snapshot->file_count(),
+                 loaded.path.c_str());
+  publish(std::move(snapshot));
+  /* collective modes compare paths only, keep what they compare against. */
+  if (mode == LOAD_LOCAL) loaded = std::move(version);
+  return true;
+}
+void h5intent::ConfigurationManager::publish(
+    std::shared_ptr<const IntentSnapshot> snapshot) {
+  std::lock_guard<std::mutex> lock(publish_mutex);
+  current.store(snapshot.get(), std::memory_order_seq_cst);
+  auto previous = std::move(current_owner);
+  current_owner = std::move(snapshot);
+  if (previous != nullptr)
+    retired.emplace_back(ReadEpoch::retire(), std::move(previous));
+  reclaim_locked();
+}
+bool h5intent::ConfigurationManager::retranslate() {
+  std::lock_guard<std::mutex> lock(load_mutex);
+  std::shared_ptr<const IntentSnapshot> snapshot;
+  {
+    std::lock_guard<std::mutex> publish_lock(publish_mutex);
+    snapshot = current_owner;
+  }
+  if (snapshot == nullptr) return false;
+  publish(snapshot->untranslated());
+  return true;
+}
+void h5intent::ConfigurationManager::reclaim() {
+  std::lock_guard<std::mutex> lock(publish_mutex);
+  reclaim_locked();
+}
+void h5intent::ConfigurationManager::reclaim_locked() {
+  if (retired.empty()) return;
+  uint64_t oldest = ReadEpoch::oldest_reader();
+  retired.erase(std::remove_if(retired.begin(), retired.end(),
+                               [oldest](const auto& entry) {
+                                 return entry.first < oldest;
+                               }),
+                retired.end());
+}
+DatasetProperties to_dataset_properties(const DatasetIOIntents &intents) {
+    auto policy = h5intent::Singleton<h5intent::PolicyRegistry>::get_instance()->policy();
+    return policy->dataset_properties(intents, h5intent::system_facts(intents.filename));
 }
 
-FileProperties to_file_properties(FileIOIntents &intents) {
-    const size_t MEMORY_SIZE = 5 * GB;
-    auto properties = FileProperties();
-    bool is_read_only = intents.mode == FileMode::FILE_READ_ONLY;
-    if (intents.process_sharing.size() == 1 && MEMORY_SIZE > intents.fs_size) {
-        properties.access.core = { true, intents.fs_size + MB, !is_read_only };
-        INTENT_LOGINFO("Core VFD is set to increment %d and flush %d for file %s",
-                       properties.access.core.increment, properties.access.core.backing_store, intents.filename.c_str())
-    }
-    return properties;
+FileProperties to_file_properties(const FileIOIntents &intents) {
+    auto policy = h5intent::Singleton<h5intent::PolicyRegistry>::get_instance()->policy();
+    return policy->file_properties(intents, h5intent::system_facts(intents.filename));
+}
+/* H5INTENT_TRANSLATE=lookup defers each record's translation to its first lookup. */
+static bool translate_on_lookup() {
+  const char* mode = getenv("H5INTENT_TRANSLATE");
+  return mode != nullptr && strcmp(mode, "lookup") == 0;
+}
+h5intent::IntentSnapshot::IntentSnapshot(std::shared_ptr<const char> storage, size_t size)
+    : storage(std::move(storage)), image(this->storage.get(), size),
+      dataset_properties(new DatasetProperties[image.dataset_count()]),
+      file_properties(new FileProperties[image.file_count()]),
+      dataset_ready(new std::once_flag[image.dataset_count()]),
+      file_ready(new std::once_flag[image.file_count()]),
+      dataset_table(nullptr), file_table(nullptr) {
+  build_patterns();
+  if (translate_on_lookup()) return;
+  /* compiled at load, so a lookup is the probe and an index into the table. */
+  for (size_t i = 0; i < image.dataset_count(); ++i) dataset(i);
+  for (size_t i = 0; i < image.file_count(); ++i) file(i);
+  dataset_table = dataset_properties.get();
+  file_table = file_properties.get();
+}
+h5intent::IntentSnapshot::IntentSnapshot(std::shared_ptr<const char> storage, size_t size,
+                                         const DatasetProperties* dataset_table,
+                                         const FileProperties* file_table)
+    : storage(std::move(storage)), image(this->storage.get(), size),
+      dataset_table(dataset_table), file_table(file_table) {
+  build_patterns();
+}
+std::shared_ptr<const h5intent::IntentSnapshot>
+h5intent::IntentSnapshot::untranslated() const {
+  /* tables from shared memory are dropped too, each rank translates again. */
+  return std::make_shared<const IntentSnapshot>(storage, image.image_size());
+}
+const DatasetProperties* h5intent::IntentSnapshot::dataset(size_t index) const {
+  if (dataset_table != nullptr) return &dataset_table[index];
+  std::call_once(dataset_ready[index], [this, index]() {
+    dataset_properties[index] = to_dataset_properties(image.to_intents(image.dataset(index)));
+  });
+  return &dataset_properties[index];
+}
+const FileProperties* h5intent::IntentSnapshot::file(size_t index) const {
+  if (file_table != nullptr) return &file_table[index];
+  std::call_once(file_ready[index], [this, index]() {
+    file_properties[index] = to_file_properties(image.to_intents(image.file(index)));
+  });
+  return &file_properties[index];
+}
+void h5intent::IntentSnapshot::build_patterns() {
+  for (size_t i = 0; i < image.dataset_count(); ++i) {
+    auto name = image.str(image.dataset(i).name);
+    if (is_intent_pattern(name) && !dataset_patterns.add(name, i))
+      INTENT_LOGWARN("dataset key %s is not a valid pattern, matched exactly only",
+                     std::string(name).c_str());
+  }
+  for (size_t i = 0; i < image.file_count(); ++i) {
+    auto name = image.str(image.file(i).filename);
+    if (is_intent_pattern(name) && !file_patterns.add(name, i))
+      INTENT_LOGWARN("file key %s is not a valid pattern, matched exactly only",
+                     std::string(name).c_str());
+  }
+  dataset_patterns.build();
+  file_patterns.build();
+}
+int64_t h5intent::IntentSnapshot::dataset_index(
+    std::string_view dataset_name) const {
+  auto index = image.find_dataset(dataset_name);
+  if (index < 0) index = dataset_patterns.match(dataset_name);
+  return index;
+}
+const DatasetProperties* h5intent::IntentSnapshot::find_dataset(
+    std::string_view dataset_name) const {
+  auto index = dataset_index(dataset_name);
+  return index < 0 ? nullptr : dataset(index);
+}
+const FileProperties* h5intent::IntentSnapshot::find_file(
+    std::string_view filename) const {
+  auto index = image.find_file(filename);
+  if (index < 0) index = file_patterns.match(filename);
+  return index < 0 ? nullptr : file(index);
 }
 bool get_dataset_properties(const char* dataset_name, struct DatasetProperties *datasetProperties) {
-  auto intents = h5intent::Singleton<h5intent::ConfigurationManager>::get_instance()->intents;
-  auto iter = intents.datasets.find(dataset_name);
-  if (iter == intents.datasets.end()) return false;
-  else {
-    iter->second.dataset_name = std::string(dataset_name);
-    *datasetProperties = to_dataset_properties(iter->second);
-    return true;
+  h5intent::ReadEpoch::Guard guard;
+  auto snapshot = h5intent::Singleton<h5intent::ConfigurationManager>::get_instance()->snapshot();
+  if (snapshot == nullptr) return false;
+  auto properties = snapshot->find_dataset(dataset_name);
+  if (properties == nullptr) return false;
+  *datasetProperties = *properties;
+  return true;
+}
+static h5intent::ChunkConstraints record_constraints(
+    const h5intent::DatasetRecord& record, const char* filename, int ndims,
+    const hsize_t* dims, const hsize_t* max_dims, size_t element_size) {
+  auto constraints = h5intent::ChunkConstraints();
+  constraints.ndims = ndims;
+  for (int d = 0; d < ndims; ++d) {
+    constraints.dims[d] = dims[d];
+    constraints.max_dims[d] = max_dims == nullptr ? dims[d] : max_dims[d];
+  }
+  constraints.element_size = element_size;
+  const auto& segment = record.segments[0];
+  constraints.segment.ndims = std::min<unsigned>(segment.ndims, SEGMENT_MAX_DIMS);
+  for (unsigned d = 0; d < constraints.segment.ndims; ++d) {
+    constraints.segment.length[d] = segment.length[d];
+    constraints.segment.stride[d] = segment.stride[d];
   }
+  constraints.segment.count = segment.count;
+  constraints.segment.access = segment.access;
+  constraints.sharing_pattern = (SharingPattern)record.sharing_pattern;
+  constraints.process_count = record.process_sharing.cardinality;
+  constraints.fs_block_size = filename != nullptr
+                                  ? h5intent::detect_filesystem(filename).io_size()
+                                  : h5intent::DEFAULT_FS_BLOCK_SIZE;
+  return constraints;
+}
+bool get_dataset_chunk(const char* dataset_name, const char* filename, int ndims,
+                       const hsize_t* dims, const hsize_t* max_dims,
+                       size_t element_size, hsize_t* chunk) {
+  h5intent::ReadEpoch::Guard guard;
+  auto snapshot = h5intent::Singleton<h5intent::ConfigurationManager>::get_instance()->snapshot();
+  if (snapshot == nullptr || ndims <= 0 || ndims > H5S_MAX_RANK) return false;
+  auto index = snapshot->dataset_index(dataset_name);
+  if (index < 0) return false;
+  auto constraints = record_constraints(snapshot->image.dataset(index), filename,
+                                        ndims, dims, max_dims, element_size);
+  return h5intent::solve_chunk_shape(constraints, chunk);
+}
+bool get_dataset_chunk_cache(const char* dataset_name, const char* filename,
+                             int ndims, const hsize_t* dims,
+                             const hsize_t* max_dims, size_t element_size,
+                             const hsize_t* chunk, size_t* rdcc_nslots,
+                             size_t* rdcc_nbytes, double* rdcc_w0) {
+  h5intent::ReadEpoch::Guard guard;
+  auto snapshot = h5intent::Singleton<h5intent::ConfigurationManager>::get_instance()->snapshot();
+  if (snapshot == nullptr || ndims <= 0 || ndims > H5S_MAX_RANK) return false;
+  auto index = snapshot->dataset_index(dataset_name);
+  if (index < 0) return false;
+  const auto& record = snapshot->image.dataset(index);
+  auto constraints = record_constraints(record, filename, ndims, dims, max_dims,
+                                        element_size);
+  auto budget = h5intent::Singleton<h5intent::MemoryBudget>::get_instance()->budget();
+  auto plan = h5intent::plan_chunk_cache(constraints, chunk,
+                                         (AccessPatternType)record.type, budget);
+  *rdcc_nslots = plan.nslots;
+  *rdcc_nbytes = plan.nbytes;
+  *rdcc_w0 = plan.w0;
+  return true;
+}
+bool reserve_core_memory(size_t bytes) {
+  return h5intent::Singleton<h5intent::MemoryBudget>::get_instance()->reserve(bytes);
+}
+void release_core_memory(size_t bytes) {
+  h5intent::Singleton<h5intent::MemoryBudget>::get_instance()->release(bytes);
+}
+int register_dataset_telemetry(const char* dataset_name) {
+  return h5intent::Singleton<h5intent::DatasetTelemetry>::get_instance()->dataset(
+      dataset_name);
+}
+void record_dataset_io(int id, bool is_write, size_t bytes, bool contiguous,
+                       uint64_t nanoseconds) {
+  if (id < 0) return;
+  h5intent::Singleton<h5intent::DatasetTelemetry>::get_instance()->record(
+      id, is_write ? h5intent::TELEMETRY_WRITE : h5intent::TELEMETRY_READ, bytes,
+      contiguous, nanoseconds);
+}
+bool is_contiguous_selection(int ndims, const hsize_t* dims, const hsize_t* start,
+                             const hsize_t* end, hsize_t npoints) {
+  return h5intent::contiguous_selection(ndims, dims, start, end, npoints);
+}
+bool dump_dataset_telemetry() {
+  return h5intent::Singleton<h5intent::DatasetTelemetry>::get_instance()->dump();
 }
 bool get_file_properties(const char* filename, struct FileProperties* fileProperties) {
-  std::filesystem::path posix_path{filename};
-  auto intents = h5intent::Singleton<h5intent::ConfigurationManager>::get_instance()->intents;
-  auto iter = intents.files.find(posix_path.generic_string());
-  if (iter == intents.files.end()) return false;
-  else {
-    iter->second.filename = posix_path.generic_string();
-    *fileProperties = to_file_properties(iter->second);
-    return true;
-  }
+  h5intent::ReadEpoch::Guard guard;
+  auto snapshot = h5intent::Singleton<h5intent::ConfigurationManager>::get_instance()->snapshot();
+  if (snapshot == nullptr) return false;
+  /* callers pass names through fix_filename, so they already are in generic form. */
+  auto properties = snapshot->find_file(filename);
+  if (properties == nullptr) return false;
+  *fileProperties = *properties;
+  return true;
 }
 struct tokens: std::ctype<char>
 {
@@ -274,6 +515,15 @@ struct tokens: std::ctype<char>
     return &rc[0];
   }
 };
+static std::string executable_name() {
+  std::string sp;
+  std::ifstream("/proc/self/cmdline") >> sp;
+  std::replace( sp.begin(), sp.end() - 1, '\000', ' ');
+  size_t firstIndex = sp.find_first_of(" ");
+  std::string path = sp.substr(0, firstIndex);
+  size_t lastIndex = path.find_last_of("/");
+  return path.substr(lastIndex + 1, -1);
+}
 bool select_correct_conf(const char* confs, char** selected_conf) {
   std::stringstream ss(confs);
   std::string s;
@@ -281,13 +531,8 @@ bool select_correct_conf(const char* confs, char** selected_conf) {
   while (getline(ss, s, ':')) {
     v.push_back(s);
   }
-  std::string sp;
-  std::ifstream("/proc/self/cmdline") >> sp;
-  std::replace( sp.begin(), sp.end() - 1, '\000', ' ');
-  size_t firstIndex = sp.find_first_of(" ");
-  std::string path = sp.substr(0, firstIndex);
-  size_t lastIndex = path.find_last_of("/");
-  std::string exec = path.substr(lastIndex + 1, -1);
+  /* the executable never changes, so /proc is read on the first call only. */
+  static const std::string exec = executable_name();
   for (auto property: v) {
     size_t lastindex = property.find_last_of(".");
     std::string rawname = property.substr(0, lastindex);
@@ -0,0 +1,353 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "cost_model.h"
+
+#include <fcntl.h>
+#include <h5intent/configuration_loader.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "chunk_solver.h"
+#include "memory_budget.h"
+
+namespace h5intent {
+static const double MB = 1024.0 * 1024.0;
+static const double GB = 1024.0 * 1024.0 * 1024.0;
+/* ROMIO's default collective buffer, what one aggregator writes at a time. */
+static const double COLLECTIVE_BUFFER = 16 * MB;
+static const size_t CALIBRATION_SYNCS = 16;
+static const size_t CALIBRATION_BLOCK = 4 * 1024 * 1024;
+static const size_t CALIBRATION_BLOCKS = 8;
+
+static size_t node_count_from_env() {
+  for (const char* name : {"H5INTENT_NODES", "SLURM_JOB_NUM_NODES", "SLURM_NNODES",
+                           "PBS_NUM_NODES"}) {
+    const char* value = getenv(name);
+    size_t nodes = value == nullptr ? 0 : std::strtoul(value, nullptr, 10);
+    if (nodes > 0) return nodes;
+  }
+  return 1;
+}
+
+MachineProfile default_profile(const FilesystemInfo& filesystem) {
+  MachineProfile profile;
+  if (filesystem.type == FS_TMPFS) {
+    profile.latency = 2e-6;
+    profile.process_bandwidth = 4 * GB;
+    profile.node_bandwidth = 16 * GB;
+  } else if (filesystem.is_parallel()) {
+    profile.latency = 1e-3;
+    profile.process_bandwidth = 1 * GB;
+    profile.node_bandwidth = 4 * GB;
+  } else {
+    profile.latency = 1e-4;
+    profile.process_bandwidth = 1 * GB;
+    profile.node_bandwidth = 2 * GB;
+  }
+  profile.node_count = node_count_from_env();
+  profile.ranks_per_node = ranks_per_node();
+  profile.filesystem_bandwidth =
+      filesystem.is_parallel() ? 64 * GB * profile.node_count : profile.node_bandwidth;
+  profile.memory_bandwidth = 4 * GB;
+  profile.network_bandwidth = 10 * GB;
+  profile.network_latency = 2e-6;
+  profile.stripe_size = filesystem.io_size();
+  profile.stripe_count = std::max<uint64_t>(filesystem.stripe_count, 1);
+  return profile;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+MachineProfile calibrate_profile(const std::string& directory) {
+  auto filesystem = detect_filesystem((std::filesystem::path(directory) / "probe").string());
+  auto profile = default_profile(filesystem);
+  auto path = (std::filesystem::path(directory) /
+               (".h5intent_calibrate_" + std::to_string(getpid()))).string();
+  int fd = open(path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+  if (fd < 0) return profile;
+  std::vector<char> buffer(CALIBRATION_BLOCK, 1);
+  bool failed = false;
+  /* synced small writes a stripe apart: the cost of a request. */
+  std::vector<double> samples;
+  for (size_t i = 0; i < CALIBRATION_SYNCS && !failed; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    failed = pwrite(fd, buffer.data(), 4 * 1024, (off_t)(i * profile.stripe_size)) < 0 ||
+             fdatasync(fd) != 0;
+    samples.push_back(seconds_since(start));
+  }
+  /* one streaming write of large requests: the bandwidth of a process. */
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < CALIBRATION_BLOCKS && !failed; ++i)
+    failed = pwrite(fd, buffer.data(), buffer.size(), (off_t)(i * buffer.size())) < 0;
+  failed = failed || fdatasync(fd) != 0;
+  double streaming = seconds_since(start);
+  close(fd);
+  unlink(path.c_str());
+  if (!failed) {
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    profile.latency = samples[samples.size() / 2];
+    double bytes = (double)CALIBRATION_BLOCK * CALIBRATION_BLOCKS;
+    profile.process_bandwidth = bytes / std::max(streaming - profile.latency, 1e-6);
+    profile.node_bandwidth = std::max(profile.node_bandwidth, profile.process_bandwidth);
+    profile.filesystem_bandwidth =
+        std::max(profile.filesystem_bandwidth, profile.node_bandwidth);
+  }
+  std::vector<char> copy(buffer.size());
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < CALIBRATION_BLOCKS; ++i)
+    memcpy(copy.data(), buffer.data(), buffer.size());
+  profile.memory_bandwidth = (double)CALIBRATION_BLOCK * CALIBRATION_BLOCKS /
+                             std::max(seconds_since(start), 1e-6);
+  return profile;
+}
+
+#define PROFILE_FIELD(field) \
+  if (j.contains(#field)) j.at(#field).get_to(profile.field);
+
+MachineProfile read_profile(const std::string& path, MachineProfile defaults) {
+  std::ifstream stream(path);
+  if (!stream) throw std::runtime_error("cannot open machine profile " + path);
+  auto profile = defaults;
+  try {
+    auto j = json::parse(stream);
+    PROFILE_FIELD(latency)
+    PROFILE_FIELD(process_bandwidth)
+    PROFILE_FIELD(node_bandwidth)
+    PROFILE_FIELD(filesystem_bandwidth)
+    PROFILE_FIELD(memory_bandwidth)
+    PROFILE_FIELD(network_bandwidth)
+    PROFILE_FIELD(network_latency)
+    PROFILE_FIELD(stripe_size)
+    PROFILE_FIELD(stripe_count)
+    PROFILE_FIELD(node_count)
+    PROFILE_FIELD(ranks_per_node)
+  } catch (const json::exception& e) {
+    throw std::runtime_error("invalid machine profile " + path + ": " + e.what());
+  }
+  return profile;
+}
+
+bool write_profile(const std::string& path, const MachineProfile& profile) {
+  json j = {{"latency", profile.latency},
+            {"process_bandwidth", profile.process_bandwidth},
+            {"node_bandwidth", profile.node_bandwidth},
+            {"filesystem_bandwidth", profile.filesystem_bandwidth},
+            {"memory_bandwidth", profile.memory_bandwidth},
+            {"network_bandwidth", profile.network_bandwidth},
+            {"network_latency", profile.network_latency},
+            {"stripe_size", profile.stripe_size},
+            {"stripe_count", profile.stripe_count},
+            {"node_count", profile.node_count},
+            {"ranks_per_node", profile.ranks_per_node}};
+  std::ofstream stream(path, std::ios::trunc);
+  stream << j.dump(2) << std::endl;
+  return stream.good();
+}
+
+MachineProfile machine_profile(const std::string& filename) {
+  auto directory = existing_directory(filename);
+  /* never destroyed, like the filesystem cache. */
+  static auto* mutex = new std::mutex();
+  static auto* cache = new std::unordered_map<std::string, MachineProfile>();
+  std::lock_guard<std::mutex> lock(*mutex);
+  auto iter = cache->find(directory);
+  if (iter != cache->end()) return iter->second;
+  auto profile = default_profile(detect_filesystem(filename));
+  const char* path = getenv("H5INTENT_MACHINE_PROFILE");
+  const char* calibrate = getenv("H5INTENT_CALIBRATE");
+  if (path != nullptr) {
+    try {
+      profile = read_profile(path, profile);
+    } catch (const std::exception& e) {
+      INTENT_LOGERROR("%s, using defaults", e.what());
+    }
+  } else if (calibrate != nullptr && strcmp(calibrate, "1") == 0) {
+    profile = calibrate_profile(directory);
+  }
+  return cache->emplace(directory, profile).first->second;
+}
+
+/* what one process does with a dataset, in bytes and requests. */
+struct Workload {
+  double access_bytes; /* one access */
+  double accesses;     /* per process */
+  double runs;         /* contiguous pieces of one access in a contiguous layout */
+  double element_size;
+  size_t processes;
+  size_t nodes;        /* spanned by the processes sharing the dataset */
+  bool write;
+};
+
+static Workload to_workload(const DatasetIOIntents& intents,
+                            const MachineProfile& profile) {
+  const auto& segment = intents.top_accessed_segments.segments[0];
+  Workload workload;
+  double elements = 1;
+  for (unsigned d = 0; d < segment.ndims; ++d)
+    elements *= std::max<hsize_t>(segment.length[d], 1);
+  auto transfer = intents.transfer_size_dist.find("1");
+  workload.access_bytes = segment.access > 0 ? (double)segment.access
+                          : transfer != intents.transfer_size_dist.end()
+                              ? (double)transfer->second
+                              : 0;
+  workload.access_bytes = std::max(workload.access_bytes, 1.0);
+  workload.element_size = std::max(workload.access_bytes / elements, 1.0);
+  workload.processes = std::max<size_t>(intents.process_sharing.size(), 1);
+  workload.accesses = std::max(
+      std::ceil((double)std::max<hsize_t>(segment.count, 1) / workload.processes), 1.0);
+  /* the extent is not known, so every dim but the last starts a new run. */
+  workload.runs = 1;
+  for (unsigned d = 0; d + 1 < segment.ndims; ++d)
+    workload.runs *= std::max<hsize_t>(segment.length[d], 1);
+  size_t ranks = std::max<size_t>(profile.ranks_per_node, 1);
+  workload.nodes = (workload.processes + ranks - 1) / ranks;
+  workload.write = intents.mode != FILE_READ_ONLY;
+  return workload;
+}
+
+/* bandwidth left to one rank when every rank of the job streams at once. */
+static double stream_bandwidth(const MachineProfile& profile) {
+  double ranks = std::max<size_t>(profile.ranks_per_node, 1);
+  double nodes = std::max<size_t>(profile.node_count, 1);
+  return std::min({profile.process_bandwidth, profile.node_bandwidth / ranks,
+                   profile.filesystem_bandwidth / (ranks * nodes)});
+}
+
+/* requests of independent writers that end inside a stripe wait for its lock. */
+static double lock_factor(const Workload& workload, const MachineProfile& profile,
+                          double request_bytes) {
+  if (workload.processes == 1 || profile.stripe_size == 0) return 1;
+  return std::fmod(request_bytes, (double)profile.stripe_size) == 0 ? 1 : 2;
+}
+
+/* writers of a shared dataset on different nodes take turns at its byte
+ * range locks, each turn a request latency per step of the exchange. The
+ * same in both modes; it is what makes shared writes slow down with the
+ * job in the recorded runs. */
+static double lock_contention(const Workload& workload, const MachineProfile& profile) {
+  if (!workload.write || workload.nodes <= 1) return 0;
+  double steps = std::ceil(std::log2((double)workload.processes));
+  return workload.processes * profile.latency * steps;
+}
+
+/* two-phase I/O of total bytes: exchange to one aggregator per node (or per
+ * stripe, if there are more), which write collective buffers. Like
+ * stream_bandwidth, every group of ranks in the job is assumed to do the
+ * same, so a node carries its share of aggregators. */
+static double collective_cost(const Workload& workload, const MachineProfile& profile,
+                              double total, double requests) {
+  double nodes = std::max<size_t>(workload.nodes, 1);
+  double aggregators = std::min<double>(
+      workload.processes, std::max<double>(nodes, profile.stripe_count));
+  double per_aggregator = total / aggregators;
+  double streams = std::max(1.0, (double)std::max<size_t>(profile.ranks_per_node, 1) *
+                                     aggregators / workload.processes);
+  double bandwidth = std::min(
+      {profile.process_bandwidth, profile.node_bandwidth / streams,
+       profile.filesystem_bandwidth /
+           (streams * std::max<size_t>(profile.node_count, 1))});
+  double steps = std::ceil(std::log2((double)workload.processes));
+  double exchange = total / (nodes * profile.network_bandwidth) +
+                    requests * profile.network_latency * steps;
+  return exchange + std::ceil(per_aggregator / COLLECTIVE_BUFFER) * profile.latency +
+         per_aggregator / bandwidth;
+}
+
+static ChunkConstraints to_constraints(const DatasetIOIntents& intents,
+                                       const Workload& workload,
+                                       const MachineProfile& profile) {
+  auto constraints = intent_constraints(intents, profile.stripe_size);
+  constraints.element_size = (size_t)workload.element_size;
+  return constraints;
+}
+
+double dataset_cost(const DatasetIOIntents& intents, const MachineProfile& profile,
+                    const DatasetCandidate& candidate) {
+  auto workload = to_workload(intents, profile);
+  double requests = workload.runs;
+  double moved = workload.access_bytes;
+  double request_bytes = workload.access_bytes / workload.runs;
+  if (candidate.chunked) {
+    auto constraints = to_constraints(intents, workload, profile);
+    double chunk_bytes = workload.element_size;
+    for (unsigned d = 0; d < candidate.ndims; ++d) chunk_bytes *= candidate.chunk[d];
+    requests = (double)chunks_per_access(constraints, candidate.chunk);
+    moved = std::max(requests * chunk_bytes, workload.access_bytes);
+    /* partially written chunks are read back first. */
+    if (workload.write && moved > workload.access_bytes) moved *= 2;
+    request_bytes = chunk_bytes;
+  }
+  double contention = workload.accesses * lock_contention(workload, profile);
+  if (candidate.collective && workload.processes > 1) {
+    double total = moved * workload.accesses * workload.processes;
+    double chunk_lookups = candidate.chunked ? requests * profile.network_latency : 0;
+    return collective_cost(workload, profile, total, workload.accesses) +
+           workload.accesses * chunk_lookups + contention;
+  }
+  double latency = profile.latency * lock_factor(workload, profile, request_bytes);
+  return workload.accesses * (requests * latency + moved / stream_bandwidth(profile)) +
+         contention;
+}
+
+std::vector<DatasetCandidate> rank_dataset_candidates(const DatasetIOIntents& intents,
+                                                      const MachineProfile& profile) {
+  auto workload = to_workload(intents, profile);
+  std::vector<DatasetCandidate> candidates;
+  DatasetCandidate contiguous{};
+  candidates.push_back(contiguous);
+  DatasetCandidate chunked{};
+  chunked.chunked = true;
+  chunked.ndims = (unsigned)std::min<size_t>(intents.ndims, H5S_MAX_RANK);
+  if (solve_chunk_shape(to_constraints(intents, workload, profile), chunked.chunk))
+    candidates.push_back(chunked);
+  if (workload.processes > 1) {
+    for (size_t i = 0, count = candidates.size(); i < count; ++i) {
+      auto collective = candidates[i];
+      collective.collective = true;
+      candidates.push_back(collective);
+    }
+  }
+  for (auto& candidate : candidates)
+    candidate.cost = dataset_cost(intents, profile, candidate);
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const DatasetCandidate& a, const DatasetCandidate& b) {
+                     return a.cost < b.cost;
+                   });
+  return candidates;
+}
+
+double file_cost(const FileIOIntents& intents, const MachineProfile& profile,
+                 bool core) {
+  double requests = 0, bytes = 0;
+  for (const auto& entry : intents.transfer_size_dist) {
+    auto sum = entry.second.find("sum"), count = entry.second.find("count");
+    if (sum != entry.second.end()) bytes += sum->second;
+    if (count != entry.second.end()) requests += count->second;
+  }
+  double file_size = (double)intents.fs_size;
+  bytes = std::max(bytes, 1.0);
+  double bandwidth = stream_bandwidth(profile);
+  if (!core) return requests * profile.latency + bytes / bandwidth;
+  /* the whole file is read at open and written back at close, new files
+   * only written and read-only ones only read. */
+  double passes = intents.mode == FILE_READ_WRITE || intents.mode == FILE_APPEND ? 2 : 1;
+  double image = std::ceil(file_size / COLLECTIVE_BUFFER) * profile.latency +
+                 file_size / bandwidth;
+  return bytes / profile.memory_bandwidth + passes * image;
+}
+}  // namespace h5intent
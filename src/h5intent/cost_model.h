@@ -0,0 +1,81 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_COST_MODEL_H
+#define H5INTENT_COST_MODEL_H
+#include <h5intent/property_dds.h>
+#include <h5intent/tuning_policy.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+/**
+ * Analytical estimate of the time one process spends on a dataset's or a
+ * file's I/O under a candidate layout, so the tuner can rank candidates
+ * instead of applying thresholds. Requests cost a latency plus their bytes
+ * over the bandwidth left to a rank once the node and the filesystem are
+ * shared by the whole job; two-phase collective I/O adds an exchange over
+ * the network and writes stripe-sized buffers from one aggregator per node;
+ * chunked layouts pay one request per chunk touched and read back partially
+ * written chunks. Writers of a shared dataset spread over nodes also queue
+ * for its locks, whichever way they transfer.
+ */
+namespace h5intent {
+struct MachineProfile {
+  double latency;              /* seconds per request to the filesystem */
+  double process_bandwidth;    /* bytes/s of one stream */
+  double node_bandwidth;       /* bytes/s of a node, shared by its ranks */
+  double filesystem_bandwidth; /* bytes/s of the filesystem for the job */
+  double memory_bandwidth;     /* bytes/s of memcpy, for the core VFD */
+  double network_bandwidth;    /* bytes/s per node in the two-phase exchange */
+  double network_latency;      /* seconds per message step */
+  uint64_t stripe_size;        /* granularity of file locks and striping */
+  uint64_t stripe_count;
+  size_t node_count;
+  size_t ranks_per_node;
+};
+
+/* conservative figures for the filesystem type, nothing is measured. */
+MachineProfile default_profile(const FilesystemInfo& filesystem);
+/**
+ * Measure latency and bandwidth of the filesystem holding directory with a
+ * short microbenchmark: synced 4 KB writes and a 32 MB streaming write to a
+ * temporary file that is removed afterwards, plus a memcpy. Figures a single
+ * process cannot see (node and filesystem bandwidth, network) keep their
+ * defaults. Falls back to default_profile if directory is not writable.
+ */
+MachineProfile calibrate_profile(const std::string& directory);
+/* @throws std::runtime_error if path cannot be read or parsed. */
+MachineProfile read_profile(const std::string& path, MachineProfile defaults);
+bool write_profile(const std::string& path, const MachineProfile& profile);
+/**
+ * Profile for the filesystem filename lives on: H5INTENT_MACHINE_PROFILE (a
+ * JSON file written by h5intent_calibrate, missing keys take defaults), else
+ * calibrated once per directory if H5INTENT_CALIBRATE=1, else the defaults.
+ */
+MachineProfile machine_profile(const std::string& filename);
+
+struct DatasetCandidate {
+  bool chunked;
+  unsigned ndims;
+  hsize_t chunk[H5S_MAX_RANK];
+  bool collective;
+  double cost; /* seconds, filled in by rank_dataset_candidates */
+};
+
+/* seconds one process spends on the dataset's accesses with candidate. */
+double dataset_cost(const DatasetIOIntents& intents, const MachineProfile& profile,
+                    const DatasetCandidate& candidate);
+/**
+ * Contiguous and chunked (solver shape) layouts, each with independent and,
+ * for shared datasets, collective transfers; cheapest first.
+ */
+std::vector<DatasetCandidate> rank_dataset_candidates(const DatasetIOIntents& intents,
+                                                      const MachineProfile& profile);
+/* seconds one process spends on the file's requests, in memory if core. */
+double file_cost(const FileIOIntents& intents, const MachineProfile& profile,
+                 bool core);
+}  // namespace h5intent
+#endif  // H5INTENT_COST_MODEL_H
@@ -0,0 +1,183 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "dataset_telemetry.h"
+
+#include <h5intent/configuration_loader.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+#include "intent_reader.h"
+
+namespace h5intent {
+size_t telemetry_bucket(uint64_t value) {
+  if (value <= 1) return 0;
+  size_t bucket = 63 - __builtin_clzll(value);
+  return std::min(bucket, TELEMETRY_BUCKETS - 1);
+}
+
+bool contiguous_selection(int ndims, const hsize_t* dims, const hsize_t* start,
+                          const hsize_t* end, hsize_t npoints) {
+  hsize_t box = 1;
+  for (int i = 0; i < ndims; ++i) box *= end[i] - start[i] + 1;
+  if (box != npoints) return false;
+  /* whole rows from the back, then one partial dimension, then single rows. */
+  int i = ndims - 1;
+  while (i > 0 && end[i] - start[i] + 1 == dims[i]) --i;
+  for (int j = 0; j < i; ++j)
+    if (end[j] != start[j]) return false;
+  return true;
+}
+
+/* tells instances apart in the per-thread cache, addresses may be reused. */
+static std::atomic<uint64_t> next_serial(1);
+
+DatasetTelemetry::DatasetTelemetry(const std::string& path)
+    : serial(next_serial.fetch_add(1)), path(path) {}
+
+static std::string telemetry_path() {
+  const char* path = getenv("H5INTENT_TELEMETRY");
+  return path == nullptr ? std::string() : std::string(path);
+}
+
+DatasetTelemetry::DatasetTelemetry() : DatasetTelemetry(telemetry_path()) {}
+
+int DatasetTelemetry::dataset(const std::string& name) {
+  if (!enabled()) return -1;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = ids.find(name);
+  if (found != ids.end()) return found->second;
+  int id = (int)names.size();
+  names.push_back(name);
+  ids.emplace(name, id);
+  return id;
+}
+
+DatasetTelemetry::ThreadTable* DatasetTelemetry::table() {
+  /* the table of every instance this thread recorded into, and the last one. */
+  thread_local std::unordered_map<uint64_t, ThreadTable*> cached;
+  thread_local uint64_t last_serial = 0;
+  thread_local ThreadTable* last = nullptr;
+  if (last_serial == serial) return last;
+  auto found = cached.find(serial);
+  if (found == cached.end()) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tables.emplace_back(new ThreadTable());
+    found = cached.emplace(serial, tables.back().get()).first;
+  }
+  last_serial = serial;
+  last = found->second;
+  return last;
+}
+
+size_t DatasetTelemetry::threads() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return tables.size();
+}
+
+DatasetCounters* DatasetTelemetry::counters(int id) {
+  auto thread = table();
+  /* only this thread resizes its table, so reading it needs no lock. */
+  if ((size_t)id < thread->counters.size() && thread->counters[id])
+    return thread->counters[id].get();
+  std::lock_guard<std::mutex> lock(thread->mutex);
+  if ((size_t)id >= thread->counters.size()) thread->counters.resize(id + 1);
+  thread->counters[id].reset(new DatasetCounters());
+  return thread->counters[id].get();
+}
+
+/* the owning thread is the only writer, so no read-modify-write is needed. */
+static inline void bump(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+}
+
+void DatasetTelemetry::record(int id, TelemetryOp op, uint64_t bytes,
+                              bool contiguous, uint64_t nanoseconds) {
+  if (id < 0 || !enabled()) return;
+  auto& counters = this->counters(id)->op[op];
+  bump(counters.ops, 1);
+  bump(counters.bytes, bytes);
+  bump(counters.nanoseconds, nanoseconds);
+  bump(contiguous ? counters.contiguous : counters.strided, 1);
+  bump(counters.size_histogram[telemetry_bucket(bytes)], 1);
+  bump(counters.latency_histogram[telemetry_bucket(nanoseconds)], 1);
+}
+
+/* running totals of one operation over all threads. */
+struct OpTotals {
+  uint64_t ops = 0, bytes = 0, nanoseconds = 0, contiguous = 0, strided = 0;
+  uint64_t size_histogram[TELEMETRY_BUCKETS] = {};
+  uint64_t latency_histogram[TELEMETRY_BUCKETS] = {};
+  void add(const OpCounters& counters) {
+    ops += counters.ops.load(std::memory_order_relaxed);
+    bytes += counters.bytes.load(std::memory_order_relaxed);
+    nanoseconds += counters.nanoseconds.load(std::memory_order_relaxed);
+    contiguous += counters.contiguous.load(std::memory_order_relaxed);
+    strided += counters.strided.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < TELEMETRY_BUCKETS; ++i) {
+      size_histogram[i] += counters.size_histogram[i].load(std::memory_order_relaxed);
+      latency_histogram[i] +=
+          counters.latency_histogram[i].load(std::memory_order_relaxed);
+    }
+  }
+};
+
+static nlohmann::json histogram_json(const uint64_t* buckets) {
+  auto histogram = nlohmann::json::object();
+  for (size_t i = 0; i < TELEMETRY_BUCKETS; ++i)
+    if (buckets[i] > 0) histogram[std::to_string(i == 0 ? 0 : 1ULL << i)] = buckets[i];
+  return histogram;
+}
+
+static nlohmann::json totals_json(const OpTotals& totals) {
+  return {{"ops", totals.ops},
+          {"bytes", totals.bytes},
+          {"seconds", totals.nanoseconds / 1e9},
+          {"contiguous", totals.contiguous},
+          {"strided", totals.strided},
+          {"size_histogram", histogram_json(totals.size_histogram)},
+          {"latency_histogram", histogram_json(totals.latency_histogram)}};
+}
+
+nlohmann::json DatasetTelemetry::to_json() {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<OpTotals> totals(names.size() * 2);
+  for (const auto& thread : tables) {
+    std::lock_guard<std::mutex> table_lock(thread->mutex);
+    for (size_t id = 0; id < thread->counters.size(); ++id) {
+      if (!thread->counters[id]) continue;
+      totals[id * 2 + TELEMETRY_READ].add(thread->counters[id]->op[TELEMETRY_READ]);
+      totals[id * 2 + TELEMETRY_WRITE].add(thread->counters[id]->op[TELEMETRY_WRITE]);
+    }
+  }
+  auto datasets = nlohmann::json::object();
+  for (size_t id = 0; id < names.size(); ++id) {
+    const auto& read = totals[id * 2 + TELEMETRY_READ];
+    const auto& write = totals[id * 2 + TELEMETRY_WRITE];
+    if (read.ops == 0 && write.ops == 0) continue;
+    datasets[names[id]] = {{"read", totals_json(read)}, {"write", totals_json(write)}};
+  }
+  return datasets;
+}
+
+bool DatasetTelemetry::dump() {
+  if (!enabled()) return false;
+  auto filename = path;
+  auto rank = current_rank();
+  if (rank >= 0) filename += "." + std::to_string(rank);
+  auto datasets = to_json();
+  std::ofstream output(filename);
+  if (!output) {
+    INTENT_LOGERROR("cannot write dataset telemetry to %s", filename.c_str())
+    return false;
+  }
+  output << datasets.dump(2) << std::endl;
+  INTENT_LOGINFO("Telemetry of %d datasets written to %s", datasets.size(),
+                 filename.c_str())
+  return (bool)output;
+}
+}  // namespace h5intent
@@ -0,0 +1,101 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_DATASET_TELEMETRY_H
+#define H5INTENT_DATASET_TELEMETRY_H
+#include <hdf5.h>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+/**
+ * What each dataset actually did, recorded by the VOL on every read and
+ * write so the effect of the applied properties can be checked without
+ * Darshan. Datasets get an id when opened or created; each thread counts
+ * into its own table indexed by that id, so recording takes no lock and
+ * touches no line another thread writes. Tables are merged when dumped.
+ */
+namespace h5intent {
+enum TelemetryOp { TELEMETRY_READ = 0, TELEMETRY_WRITE = 1 };
+
+/* log2 buckets: [2^i, 2^(i+1)), the first also holds 0, the last the rest. */
+static const size_t TELEMETRY_BUCKETS = 40;
+size_t telemetry_bucket(uint64_t value);
+
+/**
+ * Whether a selection of npoints within the bounds [start, end] of a
+ * row-major dataspace of dims is one contiguous run in the file: the box
+ * has no holes, and covers whole rows of every dimension after its first
+ * partial one.
+ */
+bool contiguous_selection(int ndims, const hsize_t* dims, const hsize_t* start,
+                          const hsize_t* end, hsize_t npoints);
+
+struct OpCounters {
+  std::atomic<uint64_t> ops;
+  std::atomic<uint64_t> bytes;
+  std::atomic<uint64_t> nanoseconds;
+  std::atomic<uint64_t> contiguous;
+  std::atomic<uint64_t> strided;
+  std::atomic<uint64_t> size_histogram[TELEMETRY_BUCKETS];    /* bytes */
+  std::atomic<uint64_t> latency_histogram[TELEMETRY_BUCKETS]; /* ns */
+};
+
+/* one dataset in one thread; only that thread writes it. */
+struct alignas(64) DatasetCounters {
+  OpCounters op[2];
+};
+
+class DatasetTelemetry {
+  struct ThreadTable {
+    /* held by the owner while it grows counters and by readers. */
+    std::mutex mutex;
+    std::vector<std::unique_ptr<DatasetCounters>> counters;
+  };
+  const uint64_t serial;
+  std::string path;
+  std::mutex mutex;
+  std::vector<std::string> names;
+  std::unordered_map<std::string, int> ids;
+  std::vector<std::unique_ptr<ThreadTable>> tables;
+  ThreadTable* table();
+  DatasetCounters* counters(int id);
+
+ public:
+  /* enabled if H5INTENT_TELEMETRY names the file to dump to. */
+  DatasetTelemetry();
+  /* enabled if path is not empty. */
+  explicit DatasetTelemetry(const std::string& path);
+  bool enabled() const { return !path.empty(); }
+  /* id of a dataset, the same for every open of it; -1 if disabled. */
+  int dataset(const std::string& name);
+  void record(int id, TelemetryOp op, uint64_t bytes, bool contiguous,
+              uint64_t nanoseconds);
+  /* threads that recorded into this instance, each with its own table. */
+  size_t threads();
+  /**
+   * Counters of all threads, per dataset name:
+   *   {"<name>": {"read": {"ops", "bytes", "seconds", "contiguous",
+   *               "strided", "size_histogram": {"<lower bound>": count},
+   *               "latency_histogram": {"<lower bound ns>": count}},
+   *               "write": {...}}, ...}
+   * Histograms only list non-empty buckets, datasets never read or
+   * written are left out.
+   */
+  nlohmann::json to_json();
+  /**
+   * Write to_json() to the configured path, with ".<rank>" appended when
+   * the rank is known so ranks do not overwrite each other.
+   * @return false if disabled or the file cannot be written.
+   */
+  bool dump();
+};
+}  // namespace h5intent
+#endif  // H5INTENT_DATASET_TELEMETRY_H
@@ -0,0 +1,124 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "filesystem_info.h"
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if __has_include(<linux/lustre/lustre_user.h>)
+#include <linux/lustre/lustre_user.h>
+#define H5INTENT_HAVE_LUSTRE 1
+#elif __has_include(<lustre/lustre_user.h>)
+#include <lustre/lustre_user.h>
+#define H5INTENT_HAVE_LUSTRE 1
+#endif
+
+namespace h5intent {
+/* f_type values; GPFS and Lustre are not in linux/magic.h. */
+static const long GPFS_MAGIC = 0x47504653;
+static const long LUSTRE_MAGIC = 0x0BD00BD0;
+static const long NFS_MAGIC = 0x6969;
+static const long XFS_MAGIC = 0x58465342;
+static const long EXT4_MAGIC = 0xEF53;
+static const long TMPFS_MAGIC = 0x01021994;
+
+const char* filesystem_name(FilesystemType type) {
+  switch (type) {
+    case FS_GPFS: return "gpfs";
+    case FS_LUSTRE: return "lustre";
+    case FS_NFS: return "nfs";
+    case FS_XFS: return "xfs";
+    case FS_EXT4: return "ext4";
+    case FS_TMPFS: return "tmpfs";
+    default: return "other";
+  }
+}
+
+static FilesystemType to_filesystem_type(long magic) {
+  switch (magic) {
+    case GPFS_MAGIC: return FS_GPFS;
+    case LUSTRE_MAGIC: return FS_LUSTRE;
+    case NFS_MAGIC: return FS_NFS;
+    case XFS_MAGIC: return FS_XFS;
+    case EXT4_MAGIC: return FS_EXT4;
+    case TMPFS_MAGIC: return FS_TMPFS;
+    default: return FS_OTHER;
+  }
+}
+
+/* default layout new files in directory get. */
+static bool lustre_stripe(const std::string& directory, FilesystemInfo& info) {
+#ifdef H5INTENT_HAVE_LUSTRE
+  int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) return false;
+  std::vector<char> buffer(sizeof(struct lov_user_md_v3) +
+                           LOV_MAX_STRIPE_COUNT *
+                               sizeof(struct lov_user_ost_data_v1));
+  auto layout = (struct lov_user_md*)buffer.data();
+  layout->lmm_magic = LOV_USER_MAGIC_V1;
+  int status = ioctl(fd, LL_IOC_LOV_GETSTRIPE, layout);
+  close(fd);
+  /* composite (PFL) layouts have no single stripe size. */
+  if (status != 0 || (layout->lmm_magic != LOV_USER_MAGIC_V1 &&
+                      layout->lmm_magic != LOV_USER_MAGIC_V3))
+    return false;
+  info.stripe_size = layout->lmm_stripe_size;
+  info.stripe_count = layout->lmm_stripe_count;
+  return info.stripe_size > 0;
+#else
+  (void)directory;
+  (void)info;
+  return false;
+#endif
+}
+
+static FilesystemInfo probe_directory(const std::string& directory) {
+  FilesystemInfo info = {FS_OTHER, 0, 0, 0};
+  struct statfs fs;
+  if (statfs(directory.c_str(), &fs) == 0) {
+    info.type = to_filesystem_type((long)fs.f_type);
+    info.block_size = fs.f_bsize;
+  }
+  struct stat st;
+  if (stat(directory.c_str(), &st) == 0)
+    info.block_size = std::max<uint64_t>(info.block_size, st.st_blksize);
+  if (info.type == FS_LUSTRE && !lustre_stripe(directory, info)) {
+    /* the Lustre client reports the stripe size as st_blksize. */
+    info.stripe_size = info.block_size;
+    info.stripe_count = 1;
+  }
+  if (info.block_size == 0) info.block_size = 4096;
+  return info;
+}
+
+std::string existing_directory(const std::string& path) {
+  std::error_code error;
+  auto directory = std::filesystem::absolute(path, error).parent_path();
+  while (!std::filesystem::is_directory(directory, error) &&
+         directory.has_parent_path() && directory != directory.parent_path())
+    directory = directory.parent_path();
+  return directory.string();
+}
+
+FilesystemInfo detect_filesystem(const std::string& path) {
+  auto key = existing_directory(path);
+  /* never destroyed, lookups may run while statics are torn down. */
+  static auto* mutex = new std::mutex();
+  static auto* cache = new std::unordered_map<std::string, FilesystemInfo>();
+  std::lock_guard<std::mutex> lock(*mutex);
+  auto iter = cache->find(key);
+  if (iter != cache->end()) return iter->second;
+  return cache->emplace(key, probe_directory(key)).first->second;
+}
+}  // namespace h5intent
@@ -0,0 +1,48 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_FILESYSTEM_INFO_H
+#define H5INTENT_FILESYSTEM_INFO_H
+#include <cstdint>
+#include <string>
+/**
+ * Type and preferred I/O granularity of the filesystem a file lives on, so
+ * the tuner can align HDF5 allocations with GPFS blocks or Lustre stripes.
+ */
+namespace h5intent {
+enum FilesystemType {
+  FS_OTHER = 0,
+  FS_GPFS = 1,
+  FS_LUSTRE = 2,
+  FS_NFS = 3,
+  FS_XFS = 4,
+  FS_EXT4 = 5,
+  FS_TMPFS = 6
+};
+
+struct FilesystemInfo {
+  FilesystemType type;
+  uint64_t block_size;   /* statfs block or st_blksize, whichever is larger */
+  uint64_t stripe_size;  /* Lustre only, 0 elsewhere */
+  uint64_t stripe_count;
+  /* unit writes should be aligned to: the stripe on Lustre, else the block. */
+  uint64_t io_size() const { return stripe_size > 0 ? stripe_size : block_size; }
+  bool is_parallel() const { return type == FS_GPFS || type == FS_LUSTRE; }
+};
+
+const char* filesystem_name(FilesystemType type);
+
+/* directory of path, or its nearest parent that exists. */
+std::string existing_directory(const std::string& path);
+
+/**
+ * Filesystem of path, or of its nearest existing parent directory since
+ * intents name files before they are created. Results are cached per
+ * directory, as file-per-process runs put thousands of files in one.
+ * Lustre stripes are read with LL_IOC_LOV_GETSTRIPE when the Lustre headers
+ * are available, otherwise taken from st_blksize.
+ */
+FilesystemInfo detect_filesystem(const std::string& path);
+}  // namespace h5intent
+#endif  // H5INTENT_FILESYSTEM_INFO_H
@@ -0,0 +1,302 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "intent_pattern.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <unordered_set>
+
+namespace h5intent {
+/* past this the DFA is dropped and lookups simulate the NFA. */
+static const size_t MAX_DFA_STATES = 4096;
+static const std::string_view RANK_PLACEHOLDER = "{rank}";
+static const std::string_view GLOB_PREFIX = "glob:";
+
+typedef PatternMatcher::Atom Atom;
+
+static bool is_regex(std::string_view key) {
+  return key.size() >= 2 && key.front() == '^' && key.back() == '$';
+}
+
+static bool is_glob(std::string_view key) {
+  return key.substr(0, GLOB_PREFIX.size()) == GLOB_PREFIX;
+}
+
+bool is_intent_pattern(std::string_view key) {
+  return is_regex(key) || is_glob(key) ||
+         key.find(RANK_PLACEHOLDER) != std::string_view::npos;
+}
+
+static std::bitset<256> single(unsigned char c) {
+  std::bitset<256> chars;
+  chars.set(c);
+  return chars;
+}
+
+static std::bitset<256> range(unsigned char first, unsigned char last) {
+  std::bitset<256> chars;
+  for (unsigned c = first; c <= last; ++c) chars.set(c);
+  return chars;
+}
+
+static bool escape_class(unsigned char c, std::bitset<256>& chars) {
+  switch (c) {
+    case 'd':
+      chars = range('0', '9');
+      return true;
+    case 'w':
+      chars = range('0', '9') | range('a', 'z') | range('A', 'Z') | single('_');
+      return true;
+    case 's':
+      chars = single(' ') | single('\t') | single('\n') | single('\r') |
+              single('\f') | single('\v');
+      return true;
+    default:
+      chars = single(c);
+      return false;
+  }
+}
+
+/* key[i] is '['; on success i is one past the closing ']'. */
+static bool parse_class(std::string_view key, size_t& i, bool glob,
+                        std::bitset<256>& chars) {
+  chars.reset();
+  size_t j = i + 1;
+  bool negate = j < key.size() && (key[j] == '^' || (glob && key[j] == '!'));
+  if (negate) ++j;
+  bool first = true;
+  for (; j < key.size() && (key[j] != ']' || first); first = false) {
+    unsigned char low = key[j];
+    if (!glob && low == '\\' && j + 1 < key.size()) {
+      std::bitset<256> escaped;
+      escape_class(key[j + 1], escaped);
+      chars |= escaped;
+      j += 2;
+      continue;
+    }
+    if (j + 2 < key.size() && key[j + 1] == '-' && key[j + 2] != ']') {
+      unsigned char high = key[j + 2];
+      if (high < low) return false;
+      chars |= range(low, high);
+      j += 3;
+    } else {
+      chars.set(low);
+      ++j;
+    }
+  }
+  if (j >= key.size()) return false;
+  if (negate) chars.flip();
+  i = j + 1;
+  return true;
+}
+
+/* without wildcards only {rank} is special, the rest is literal. */
+static bool parse_glob(std::string_view key, bool wildcards,
+                       std::vector<Atom>& atoms) {
+  for (size_t i = 0; i < key.size();) {
+    unsigned char c = key[i];
+    if (key.compare(i, RANK_PLACEHOLDER.size(), RANK_PLACEHOLDER) == 0) {
+      atoms.push_back({range('0', '9'), PatternMatcher::REPEAT_ONE});
+      atoms.push_back({range('0', '9'), PatternMatcher::REPEAT_STAR});
+      i += RANK_PLACEHOLDER.size();
+    } else if (!wildcards) {
+      atoms.push_back({single(c), PatternMatcher::REPEAT_ONE});
+      ++i;
+    } else if (c == '*') {
+      atoms.push_back({std::bitset<256>().set(), PatternMatcher::REPEAT_STAR});
+      ++i;
+    } else if (c == '?') {
+      atoms.push_back({std::bitset<256>().set(), PatternMatcher::REPEAT_ONE});
+      ++i;
+    } else if (c == '[') {
+      std::bitset<256> chars;
+      if (!parse_class(key, i, true, chars)) return false;
+      atoms.push_back({chars, PatternMatcher::REPEAT_ONE});
+    } else if (c == '\\' && i + 1 < key.size()) {
+      atoms.push_back({single(key[i + 1]), PatternMatcher::REPEAT_ONE});
+      i += 2;
+    } else {
+      atoms.push_back({single(c), PatternMatcher::REPEAT_ONE});
+      ++i;
+    }
+  }
+  return true;
+}
+
+static bool parse_regex(std::string_view key, std::vector<Atom>& atoms) {
+  /* strip the anchors, the pattern always has to match the whole name. */
+  key = key.substr(1, key.size() - 2);
+  for (size_t i = 0; i < key.size();) {
+    unsigned char c = key[i];
+    if (c == '*' || c == '+' || c == '?') {
+      if (atoms.empty() || atoms.back().repeat != PatternMatcher::REPEAT_ONE)
+        return false;
+      if (c == '*') atoms.back().repeat = PatternMatcher::REPEAT_STAR;
+      if (c == '?') atoms.back().repeat = PatternMatcher::REPEAT_OPTIONAL;
+      if (c == '+') {
+        auto chars = atoms.back().chars;
+        atoms.push_back({chars, PatternMatcher::REPEAT_STAR});
+      }
+      ++i;
+    } else if (c == '.') {
+      atoms.push_back({std::bitset<256>().set(), PatternMatcher::REPEAT_ONE});
+      ++i;
+    } else if (c == '[') {
+      std::bitset<256> chars;
+      if (!parse_class(key, i, false, chars)) return false;
+      atoms.push_back({chars, PatternMatcher::REPEAT_ONE});
+    } else if (c == '\\') {
+      if (i + 1 >= key.size()) return false;
+      std::bitset<256> chars;
+      escape_class(key[i + 1], chars);
+      atoms.push_back({chars, PatternMatcher::REPEAT_ONE});
+      i += 2;
+    } else if (strchr("()|{}^$", c) != nullptr) {
+      return false;
+    } else {
+      atoms.push_back({single(c), PatternMatcher::REPEAT_ONE});
+      ++i;
+    }
+  }
+  return true;
+}
+
+PatternMatcher::PatternMatcher()
+    : patterns(),
+      state_pattern(),
+      byte_class(),
+      class_count(0),
+      transitions(),
+      accepts(),
+      start_state(0),
+      start_set() {}
+
+bool PatternMatcher::add(std::string_view key, uint32_t record) {
+  Pattern pattern = {{}, record, 0, (uint32_t)state_pattern.size()};
+  bool parsed;
+  if (is_regex(key))
+    parsed = parse_regex(key, pattern.atoms);
+  else if (is_glob(key))
+    parsed = parse_glob(key.substr(GLOB_PREFIX.size()), true, pattern.atoms);
+  else
+    parsed = parse_glob(key, false, pattern.atoms);
+  if (!parsed) return false;
+  for (const auto& atom : pattern.atoms)
+    if (atom.repeat == REPEAT_ONE && atom.chars.count() == 1) pattern.literals++;
+  state_pattern.insert(state_pattern.end(), pattern.atoms.size() + 1,
+                       (uint32_t)patterns.size());
+  patterns.push_back(std::move(pattern));
+  return true;
+}
+
+void PatternMatcher::closure(std::vector<uint32_t>& states) const {
+  for (size_t k = 0; k < states.size(); ++k) {
+    const auto& pattern = patterns[state_pattern[states[k]]];
+    uint32_t position = states[k] - pattern.first_state;
+    if (position < pattern.atoms.size() &&
+        pattern.atoms[position].repeat != REPEAT_ONE)
+      states.push_back(states[k] + 1);
+  }
+  std::sort(states.begin(), states.end());
+  states.erase(std::unique(states.begin(), states.end()), states.end());
+}
+
+void PatternMatcher::step(const std::vector<uint32_t>& from, unsigned char c,
+                          std::vector<uint32_t>& to) const {
+  to.clear();
+  for (auto state : from) {
+    const auto& pattern = patterns[state_pattern[state]];
+    uint32_t position = state - pattern.first_state;
+    if (position == pattern.atoms.size()) continue;
+    const auto& atom = pattern.atoms[position];
+    if (!atom.chars.test(c)) continue;
+    to.push_back(atom.repeat == REPEAT_STAR ? state : state + 1);
+  }
+  closure(to);
+}
+
+int64_t PatternMatcher::best_record(const std::vector<uint32_t>& states) const {
+  const Pattern* best = nullptr;
+  for (auto state : states) {
+    const auto& pattern = patterns[state_pattern[state]];
+    if (state - pattern.first_state != pattern.atoms.size()) continue;
+    if (best == nullptr || pattern.literals > best->literals ||
+        (pattern.literals == best->literals && pattern.record < best->record))
+      best = &pattern;
+  }
+  return best == nullptr ? -1 : (int64_t)best->record;
+}
+
+void PatternMatcher::build() {
+  transitions.clear();
+  accepts.clear();
+  start_set.clear();
+  if (patterns.empty()) return;
+  for (const auto& pattern : patterns) start_set.push_back(pattern.first_state);
+  closure(start_set);
+
+  /* bytes that no atom tells apart share a column of the table. */
+  std::unordered_set<std::bitset<256>> distinct;
+  for (const auto& pattern : patterns)
+    for (const auto& atom : pattern.atoms) distinct.insert(atom.chars);
+  std::vector<std::bitset<256>> sets(distinct.begin(), distinct.end());
+  std::map<std::vector<bool>, uint8_t> signatures;
+  std::vector<unsigned char> representative;
+  for (unsigned c = 0; c < 256; ++c) {
+    std::vector<bool> signature(sets.size());
+    for (size_t s = 0; s < sets.size(); ++s) signature[s] = sets[s].test(c);
+    auto inserted = signatures.emplace(signature, (uint8_t)signatures.size());
+    if (inserted.second) representative.push_back((unsigned char)c);
+    byte_class[c] = inserted.first->second;
+  }
+  class_count = representative.size();
+
+  std::map<std::vector<uint32_t>, uint32_t> ids;
+  std::vector<std::vector<uint32_t>> dfa_states = {{}, start_set};
+  ids[dfa_states[0]] = 0;
+  ids[dfa_states[1]] = 1;
+  start_state = 1;
+  transitions.assign(2 * class_count, 0);
+  std::vector<uint32_t> next;
+  for (uint32_t id = 1; id < dfa_states.size(); ++id) {
+    for (uint32_t cls = 0; cls < class_count; ++cls) {
+      step(dfa_states[id], representative[cls], next);
+      auto inserted = ids.emplace(next, (uint32_t)dfa_states.size());
+      if (inserted.second) {
+        if (dfa_states.size() == MAX_DFA_STATES) {
+          transitions.clear();
+          return;
+        }
+        dfa_states.push_back(next);
+        transitions.resize(dfa_states.size() * class_count, 0);
+      }
+      transitions[id * class_count + cls] = inserted.first->second;
+    }
+  }
+  accepts.resize(dfa_states.size());
+  for (uint32_t id = 0; id < dfa_states.size(); ++id)
+    accepts[id] = best_record(dfa_states[id]);
+}
+
+int64_t PatternMatcher::match(std::string_view name) const {
+  if (patterns.empty()) return -1;
+  if (!transitions.empty()) {
+    uint32_t state = start_state;
+    for (unsigned char c : name) {
+      state = transitions[state * class_count + byte_class[c]];
+      if (state == 0) return -1;
+    }
+    return accepts[state];
+  }
+  std::vector<uint32_t> current = start_set, next;
+  for (unsigned char c : name) {
+    step(current, c, next);
+    if (next.empty()) return -1;
+    current.swap(next);
+  }
+  return best_record(current);
+}
+}  // namespace h5intent
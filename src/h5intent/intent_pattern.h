@@ -0,0 +1,81 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_INTENT_PATTERN_H
+#define H5INTENT_INTENT_PATTERN_H
+#include <bitset>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+/**
+ * Intent keys that stand for many files or datasets.
+ *
+ *    /scratch/rank_{rank}_test.h5      {rank} matches a decimal rank number
+ *    glob:/scratch/run_?/out_*.h5      glob: *, ?, [a-z], [!0-9], \ escapes
+ *                                      and {rank}
+ *    ^/scratch/.+_[0-9]+_test\.h5$     anchored regex: literals, ., \d, \w,
+ *                                      \s, [...] and the *, +, ? repeats
+ *
+ * Glob characters only count after the glob: prefix, so names that contain
+ * *, ? or [ stay exact keys.
+ * Regexes may not use groups or alternation, so every pattern is a sequence
+ * of repeated character classes. All patterns of a snapshot are compiled into
+ * one DFA and a lookup is one table step per character. When several
+ * patterns match, the one with the most literal characters wins, then the
+ * one with the lowest record index. Exact keys are resolved before patterns.
+ */
+namespace h5intent {
+/* true if the key is any of the pattern forms above. */
+bool is_intent_pattern(std::string_view key);
+
+class PatternMatcher {
+ public:
+  enum Repeat { REPEAT_ONE = 0, REPEAT_OPTIONAL = 1, REPEAT_STAR = 2 };
+  struct Atom {
+    std::bitset<256> chars;
+    Repeat repeat;
+  };
+
+ private:
+  struct Pattern {
+    std::vector<Atom> atoms;
+    uint32_t record;
+    uint32_t literals;
+    uint32_t first_state;
+  };
+  std::vector<Pattern> patterns;
+  /* NFA state -> pattern, a pattern owns atoms.size() + 1 states. */
+  std::vector<uint32_t> state_pattern;
+  uint8_t byte_class[256];
+  uint32_t class_count;
+  /* dense DFA, state 0 is the dead state. Empty if it grew too large, in
+   * which case match() simulates the NFA instead. */
+  std::vector<uint32_t> transitions;
+  std::vector<int64_t> accepts;
+  uint32_t start_state;
+  std::vector<uint32_t> start_set;
+
+  void closure(std::vector<uint32_t>& states) const;
+  void step(const std::vector<uint32_t>& from, unsigned char c,
+            std::vector<uint32_t>& to) const;
+  int64_t best_record(const std::vector<uint32_t>& states) const;
+
+ public:
+  PatternMatcher();
+  /**
+   * Parse and add a pattern for a record.
+   * @return false if the key is not a pattern this matcher understands.
+   */
+  bool add(std::string_view key, uint32_t record);
+  /* compile the automaton; call once after the last add. */
+  void build();
+  bool empty() const { return patterns.empty(); }
+  size_t size() const { return patterns.size(); }
+  /**
+   * @return record of the best matching pattern or -1.
+   */
+  int64_t match(std::string_view name) const;
+};
+}  // namespace h5intent
+#endif  // H5INTENT_INTENT_PATTERN_H
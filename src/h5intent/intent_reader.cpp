@@ -0,0 +1,183 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "intent_reader.h"
+
+#include <h5intent/configuration_loader.h>
+#include <mpi.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+
+#include "compiled_intents.h"
+#include "intent_stream.h"
+
+namespace h5intent {
+LoadMode load_mode_from_env() {
+  const char* mode = getenv("H5INTENT_LOAD_MODE");
+  if (mode == nullptr) return LOAD_LOCAL;
+  if (strcmp(mode, "collective") == 0) return LOAD_COLLECTIVE;
+  if (strcmp(mode, "node") == 0) return LOAD_NODE;
+  if (strcmp(mode, "shared") == 0) return LOAD_SHARED;
+  if (strcmp(mode, "local") != 0)
+    INTENT_LOGWARN("unknown H5INTENT_LOAD_MODE %s, using local", mode);
+  return LOAD_LOCAL;
+}
+
+bool active_communicator(MPI_Comm comm) {
+  int initialized = 0, finalized = 0;
+  MPI_Initialized(&initialized);
+  MPI_Finalized(&finalized);
+  return comm != MPI_COMM_NULL && initialized && !finalized;
+}
+
+ConfigurationVersion configuration_version(const std::string& path,
+                                           MPI_Comm comm) {
+  ConfigurationVersion version;
+  std::error_code error;
+  auto canonical = std::filesystem::weakly_canonical(path, error);
+  version.path = error ? path : canonical.string();
+  bool collective = active_communicator(comm);
+  int rank = 0;
+  if (collective) MPI_Comm_rank(comm, &rank);
+  /* device, inode, size, mtime; all zero if the file cannot be stat'ed. */
+  uint64_t identity[4] = {0, 0, 0, 0};
+  struct stat st;
+  if (rank == 0 && stat(version.path.c_str(), &st) == 0) {
+    identity[0] = st.st_dev;
+    identity[1] = st.st_ino;
+    identity[2] = st.st_size;
+    identity[3] = (uint64_t)((int64_t)st.st_mtim.tv_sec * 1000000000L +
+                             st.st_mtim.tv_nsec);
+  }
+  if (collective) MPI_Bcast(identity, 4, MPI_UINT64_T, 0, comm);
+  version.device = identity[0];
+  version.inode = identity[1];
+  version.size = identity[2];
+  version.mtime_ns = (int64_t)identity[3];
+  return version;
+}
+
+int64_t current_rank() {
+  /* cached, so later calls (e.g. from the reload thread) never enter MPI. */
+  static std::atomic<int64_t> cached(-1);
+  int64_t rank = cached.load(std::memory_order_relaxed);
+  if (rank >= 0) return rank;
+  int initialized = 0, finalized = 0;
+  MPI_Initialized(&initialized);
+  MPI_Finalized(&finalized);
+  if (initialized && !finalized) {
+    int world_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    cached.store(world_rank, std::memory_order_relaxed);
+    return world_rank;
+  }
+  /* HDF5 may be initialized before MPI_Init, so ask the launcher. */
+  for (const char* name : {"H5INTENT_RANK", "PMI_RANK", "PMIX_RANK",
+                           "OMPI_COMM_WORLD_RANK", "SLURM_PROCID"}) {
+    const char* value = getenv(name);
+    char* end = nullptr;
+    if (value == nullptr || *value == '\0') continue;
+    rank = strtol(value, &end, 10);
+    if (*end == '\0' && rank >= 0) {
+      cached.store(rank, std::memory_order_relaxed);
+      return rank;
+    }
+    INTENT_LOGWARN("ignoring %s=%s, not a rank", name, value);
+  }
+  return -1;
+}
+
+IntentFilter rank_filter_from_env() {
+  const char* enabled = getenv("H5INTENT_RANK_FILTER");
+  if (enabled == nullptr || strcmp(enabled, "1") != 0) return nullptr;
+  int64_t rank = current_rank();
+  if (rank < 0) {
+    INTENT_LOGWARN("H5INTENT_RANK_FILTER=%s but the rank is unknown", enabled);
+    return nullptr;
+  }
+  return [rank](const std::string& name, SharingPattern sharing,
+                const RankSet& process_sharing) {
+    return sharing == COLLECTIVE || process_sharing.empty() ||
+           process_sharing.contains((uint32_t)rank) || is_intent_pattern(name);
+  };
+}
+
+std::shared_ptr<const char> read_intent_image(const std::string& path,
+                                              size_t& size,
+                                              const IntentFilter& keep) {
+  auto storage = map_file(path, size);
+  if (storage == nullptr) {
+    INTENT_LOGERROR("could not read conf %s", path.c_str());
+    return nullptr;
+  }
+  if (CompiledIntents::is_compiled(storage.get(), size)) return storage;
+  /* JSON is streamed into the image, never held as a whole DOM. */
+  storage.reset();
+  auto image = std::make_shared<std::vector<char>>(compile_intents_file(path, keep));
+  size = image->size();
+  return std::shared_ptr<const char>(image, image->data());
+}
+
+/* MPI counts are ints, so large images go out in INT_MAX sized pieces. */
+static void broadcast_bytes(char* data, size_t size, MPI_Comm comm) {
+  for (size_t offset = 0; offset < size; offset += INT_MAX) {
+    int count = (int)std::min<size_t>(INT_MAX, size - offset);
+    MPI_Bcast(data + offset, count, MPI_BYTE, 0, comm);
+  }
+}
+
+std::shared_ptr<const char> broadcast_intent_image(const std::string& path,
+                                                   size_t& size, MPI_Comm comm) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  std::shared_ptr<const char> storage;
+  uint64_t image_size = 0;
+  if (rank == 0) {
+    /* the reader compiles, so the others receive the ready-to-use image. */
+    try {
+      storage = read_intent_image(path, size);
+    } catch (const std::exception& e) {
+      INTENT_LOGERROR("loading conf %s failed: %s", path.c_str(), e.what());
+      storage = nullptr;
+    }
+    image_size = storage == nullptr ? 0 : size;
+  }
+  MPI_Bcast(&image_size, 1, MPI_UINT64_T, 0, comm);
+  if (image_size > 0) {
+    if (rank == 0) {
+      broadcast_bytes(const_cast<char*>(storage.get()), image_size, comm);
+    } else {
+      auto image = std::make_shared<std::vector<char>>(image_size);
+      broadcast_bytes(image->data(), image_size, comm);
+      storage = std::shared_ptr<const char>(image, image->data());
+    }
+  }
+  size = image_size;
+  return image_size > 0 ? storage : nullptr;
+}
+
+std::shared_ptr<const char> read_intent_image(const std::string& path,
+                                              size_t& size, LoadMode mode,
+                                              MPI_Comm comm) {
+  if (mode == LOAD_LOCAL || !active_communicator(comm)) {
+    if (mode != LOAD_LOCAL)
+      INTENT_LOGINFO("no active communicator, reading conf %s on this rank",
+                     path.c_str());
+    return read_intent_image(path, size, rank_filter_from_env());
+  }
+  if (getenv("H5INTENT_RANK_FILTER") != nullptr)
+    INTENT_LOGINFO("H5INTENT_RANK_FILTER only applies to local loads, keeping "
+                   "every entry of conf %s", path.c_str());
+  if (mode != LOAD_NODE) return broadcast_intent_image(path, size, comm);
+  MPI_Comm node_comm;
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+  auto storage = broadcast_intent_image(path, size, node_comm);
+  MPI_Comm_free(&node_comm);
+  return storage;
+}
+}  // namespace h5intent
@@ -0,0 +1,84 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_INTENT_READER_H
+#define H5INTENT_INTENT_READER_H
+#include <mpi.h>
+
+#include <memory>
+#include <string>
+
+#include "intent_stream.h"
+/**
+ * Produces the compiled intent image for a configuration file, either by
+ * reading it on every rank or by reading it once and broadcasting it.
+ */
+namespace h5intent {
+enum LoadMode : int {
+  LOAD_LOCAL = 0,      /* every rank reads the file */
+  LOAD_COLLECTIVE = 1, /* rank 0 reads, broadcast to every rank of the job */
+  LOAD_NODE = 2,       /* one rank per node reads, broadcast within the node */
+  LOAD_SHARED = 3      /* rank 0 reads, one read-only shared copy per node */
+};
+
+/* H5INTENT_LOAD_MODE=local|collective|node|shared, defaults to local. */
+LoadMode load_mode_from_env();
+
+/* true if comm is a communicator MPI can still be used on. */
+bool active_communicator(MPI_Comm comm);
+
+/**
+ * Version of path. Collective over comm when it is active: rank 0 stats the
+ * file and broadcasts the result, since ranks may see different attributes
+ * of a shared file and each of them has to make the same decision before a
+ * broadcast. With MPI_COMM_NULL the file is stat'ed on this rank.
+ * @return version, without file identity if path cannot be stat'ed.
+ */
+ConfigurationVersion configuration_version(const std::string& path,
+                                           MPI_Comm comm);
+
+/**
+ * This process' rank: MPI_COMM_WORLD when MPI is active, otherwise
+ * H5INTENT_RANK or the rank exported by the launcher.
+ * @return rank or -1 if it is unknown.
+ */
+int64_t current_rank();
+
+/**
+ * With H5INTENT_RANK_FILTER=1, keeps only the entries this rank can touch:
+ * collective entries (opened by every rank), pattern keys, entries without
+ * process_sharing and entries whose process_sharing contains current_rank().
+ * @return the filter, or nullptr when it is disabled or the rank is unknown.
+ */
+IntentFilter rank_filter_from_env();
+
+/**
+ * Read and, for JSON input, compile the configuration on this rank only.
+ * JSON entries rejected by keep are skipped while parsing; compiled images
+ * are used as is.
+ * @return compiled image or nullptr if the file could not be read.
+ */
+std::shared_ptr<const char> read_intent_image(const std::string& path,
+                                              size_t& size,
+                                              const IntentFilter& keep = nullptr);
+
+/**
+ * Rank 0 of comm reads the configuration and broadcasts the compiled image
+ * to the other ranks of comm. Collective over comm.
+ */
+std::shared_ptr<const char> broadcast_intent_image(const std::string& path,
+                                                   size_t& size, MPI_Comm comm);
+
+/**
+ * Collective version of read_intent_image. Must be called by every rank of
+ * comm; node mode broadcasts within the ranks of comm sharing a node. Falls
+ * back to a local read when MPI is not initialized (or already finalized)
+ * or comm is MPI_COMM_NULL. Only local reads apply rank_filter_from_env(),
+ * broadcast images are the same on every rank.
+ */
+std::shared_ptr<const char> read_intent_image(const std::string& path,
+                                              size_t& size, LoadMode mode,
+                                              MPI_Comm comm);
+}  // namespace h5intent
+#endif  // H5INTENT_INTENT_READER_H
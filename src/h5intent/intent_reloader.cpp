@@ -0,0 +1,123 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "intent_reloader.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+namespace h5intent {
+/* how often retired snapshots are reclaimed while idle. */
+static const int RECLAIM_INTERVAL_MS = 1000;
+/* editors write in several steps; reload once they went quiet. */
+static const int SETTLE_MS = 100;
+
+std::atomic<int> IntentReloader::wake_fd(-1);
+
+ReloadMode reload_mode_from_env() {
+  const char* mode = getenv("H5INTENT_RELOAD");
+  if (mode == nullptr) return RELOAD_OFF;
+  if (strcmp(mode, "signal") == 0) return RELOAD_SIGNAL;
+  if (strcmp(mode, "watch") == 0) return RELOAD_WATCH;
+  if (strcmp(mode, "off") != 0)
+    INTENT_LOGWARN("unknown H5INTENT_RELOAD %s, using off", mode);
+  return RELOAD_OFF;
+}
+
+IntentReloader::IntentReloader()
+    : manager(nullptr), path(), inotify_fd(-1), running(false), worker() {}
+
+IntentReloader::~IntentReloader() { stop(); }
+
+bool IntentReloader::start(ConfigurationManager* manager,
+                           const std::string& path, ReloadMode mode) {
+  stop();
+  if (mode == RELOAD_OFF) return false;
+  int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (fd < 0) {
+    INTENT_LOGERROR("cannot reload conf %s: eventfd failed: %s", path.c_str(),
+                    strerror(errno));
+    return false;
+  }
+  if (mode == RELOAD_WATCH) {
+    /* watch the directory, since editors and tools replace files by rename. */
+    auto directory = std::filesystem::absolute(path).parent_path();
+    inotify_fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (inotify_fd < 0 ||
+        inotify_add_watch(inotify_fd, directory.c_str(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+      INTENT_LOGWARN("cannot watch %s (%s), reloading on SIGHUP only",
+                     directory.c_str(), strerror(errno));
+      if (inotify_fd >= 0) close(inotify_fd);
+      inotify_fd = -1;
+    }
+  }
+  this->manager = manager;
+  this->path = path;
+  running.store(true);
+  wake_fd.store(fd);
+  worker = std::thread(&IntentReloader::run, this);
+  return true;
+}
+
+void IntentReloader::stop() {
+  if (!worker.joinable()) return;
+  running.store(false);
+  request();
+  worker.join();
+  close(wake_fd.exchange(-1));
+  if (inotify_fd >= 0) close(inotify_fd);
+  inotify_fd = -1;
+}
+
+void IntentReloader::request() {
+  int fd = wake_fd.load();
+  if (fd < 0) return;
+  uint64_t one = 1;
+  ssize_t written = write(fd, &one, sizeof(one));
+  (void)written;
+}
+
+bool IntentReloader::file_changed() {
+  auto name = std::filesystem::path(path).filename().string();
+  alignas(struct inotify_event) char buffer[4096];
+  bool changed = false;
+  ssize_t length;
+  while ((length = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+    for (char* next = buffer; next < buffer + length;) {
+      auto event = (const struct inotify_event*)next;
+      if (event->len > 0 && name == event->name) changed = true;
+      next += sizeof(struct inotify_event) + event->len;
+    }
+  }
+  return changed;
+}
+
+void IntentReloader::run() {
+  int event_fd = wake_fd.load();
+  struct pollfd fds[2] = {{event_fd, POLLIN, 0}, {inotify_fd, POLLIN, 0}};
+  nfds_t count = inotify_fd >= 0 ? 2 : 1;
+  while (running.load()) {
+    int ready = poll(fds, count, RECLAIM_INTERVAL_MS);
+    manager->reclaim();
+    if (ready <= 0 || !running.load()) continue;
+    bool reload = false;
+    uint64_t requests;
+    if ((fds[0].revents & POLLIN) &&
+        read(event_fd, &requests, sizeof(requests)) > 0)
+      reload = true;
+    if (count > 1 && (fds[1].revents & POLLIN) && file_changed()) {
+      while (poll(&fds[1], 1, SETTLE_MS) > 0) file_changed();
+      reload = true;
+    }
+    if (reload && running.load()) manager->reload_configuration();
+  }
+}
+}  // namespace h5intent
@@ -0,0 +1,55 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_INTENT_RELOADER_H
+#define H5INTENT_INTENT_RELOADER_H
+#include <h5intent/configuration_loader.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+/**
+ * Background thread that reloads the configuration on SIGHUP or, when
+ * watching, whenever the file is rewritten or replaced. New snapshots are
+ * published with ConfigurationManager::publish, so the I/O path never waits
+ * for a reload and lookups in flight finish on the snapshot they started on.
+ */
+namespace h5intent {
+enum ReloadMode {
+  RELOAD_OFF = 0,    /* SIGHUP is only logged */
+  RELOAD_SIGNAL = 1, /* reload on SIGHUP */
+  RELOAD_WATCH = 2   /* reload on SIGHUP and on changes of the file */
+};
+
+/* H5INTENT_RELOAD=off|signal|watch, defaults to off. */
+ReloadMode reload_mode_from_env();
+
+class IntentReloader {
+  /* wakes the thread; also written by the signal handler. */
+  static std::atomic<int> wake_fd;
+  ConfigurationManager* manager;
+  std::string path;
+  int inotify_fd;
+  std::atomic<bool> running;
+  std::thread worker;
+  bool file_changed();
+  void run();
+
+ public:
+  IntentReloader();
+  ~IntentReloader();
+  IntentReloader(const IntentReloader& other) = delete;
+  IntentReloader& operator=(const IntentReloader& other) = delete;
+  /**
+   * Start reloading path into manager, restarting if already running.
+   * @return false if mode is RELOAD_OFF or the thread could not be set up.
+   */
+  bool start(ConfigurationManager* manager, const std::string& path,
+             ReloadMode mode);
+  void stop();
+  /* ask for a reload; async-signal-safe. */
+  static void request();
+};
+}  // namespace h5intent
+#endif  // H5INTENT_INTENT_RELOADER_H
@@ -0,0 +1,232 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "intent_stream.h"
+
+#include <fstream>
+#include <stdexcept>
+
+#include "compiled_intents.h"
+
+namespace h5intent {
+namespace {
+/**
+ * Depth 1 is the top level object, depth 2 a section ("files" or
+ * "datasets") and depth 3 one entry. Events below depth 3 build a json value
+ * for that entry only; it is converted and dropped when the entry closes.
+ */
+class IntentSaxHandler : public nlohmann::json_sax<json> {
+  enum Section { SECTION_OTHER, SECTION_FILES, SECTION_DATASETS };
+  const DatasetSink& on_dataset;
+  const FileSink& on_file;
+  const IntentFilter& keep;
+  size_t depth;
+  Section section;
+  std::string entry_name;
+  json entry;
+  /* open containers of the entry, innermost last. */
+  std::vector<json*> stack;
+  std::string member;
+  /* member of the entry itself that is being parsed. */
+  std::string field;
+  bool has_sharing, has_ranks;
+  /* keep ran on the entry already; a rejected one builds nothing more. */
+  bool decided, rejected;
+
+  bool value(json&& value) {
+    if (stack.empty()) {
+      if (depth == 2 && section != SECTION_OTHER)
+        throw std::runtime_error("intent " + entry_name + " is not an object");
+      return true;
+    }
+    json* top = stack.back();
+    if (top->is_array())
+      top->push_back(std::move(value));
+    else
+      (*top)[member] = std::move(value);
+    if (stack.size() == 1) field_done();
+    return true;
+  }
+  bool open(json&& container) {
+    if (stack.empty()) return true;
+    json* top = stack.back();
+    if (top->is_array()) {
+      top->push_back(std::move(container));
+      stack.push_back(&top->back());
+    } else {
+      stack.push_back(&((*top)[member] = std::move(container)));
+    }
+    return true;
+  }
+  void close() {
+    stack.pop_back();
+    if (stack.size() == 1) field_done();
+  }
+  bool accepted() const {
+    if (!keep) return true;
+    h5intent::RankSet process_sharing;
+    auto ranks = entry.find("process_sharing");
+    if (ranks != entry.end()) from_json(*ranks, process_sharing);
+    auto sharing = entry.find("sharing_pattern");
+    bool missing = sharing == entry.end() || sharing->is_null();
+    return keep(entry_name,
+                missing ? INDEPENDENT : (SharingPattern)sharing->get<int>(),
+                process_sharing);
+  }
+  /**
+   * Filter as soon as the sharing of the entry is known, so a rejected entry
+   * stops building its json before the (large) members that follow it.
+   */
+  void field_done() {
+    if (field == "sharing_pattern")
+      has_sharing = true;
+    else if (field == "process_sharing")
+      has_ranks = true;
+    else
+      return;
+    if (!keep || !has_sharing || !has_ranks || section == SECTION_OTHER) return;
+    decided = true;
+    if (accepted()) return;
+    rejected = true;
+    entry = json();
+    stack.clear();
+  }
+  void emit() {
+    if (section == SECTION_OTHER || rejected || (!decided && !accepted())) {
+    } else if (section == SECTION_DATASETS) {
+      DatasetIOIntents intents{};
+      from_json(entry, intents);
+      on_dataset(std::move(entry_name), std::move(intents));
+    } else if (section == SECTION_FILES) {
+      FileIOIntents intents{};
+      from_json(entry, intents);
+      on_file(std::move(entry_name), std::move(intents));
+    }
+    entry = json();
+    stack.clear();
+  }
+
+ public:
+  IntentSaxHandler(const DatasetSink& on_dataset, const FileSink& on_file,
+                   const IntentFilter& keep)
+      : on_dataset(on_dataset),
+        on_file(on_file),
+        keep(keep),
+        depth(0),
+        section(SECTION_OTHER),
+        entry_name(),
+        entry(),
+        stack(),
+        member(),
+        field(),
+        has_sharing(false),
+        has_ranks(false),
+        decided(false),
+        rejected(false) {}
+
+  bool null() override { return value(nullptr); }
+  bool boolean(bool val) override { return value(val); }
+  bool number_integer(number_integer_t val) override { return value(val); }
+  bool number_unsigned(number_unsigned_t val) override { return value(val); }
+  bool number_float(number_float_t val, const string_t&) override {
+    return value(val);
+  }
+  bool string(string_t& val) override { return value(std::move(val)); }
+  bool binary(binary_t& val) override {
+    return value(json::binary(std::move(val)));
+  }
+  bool start_object(std::size_t) override {
+    if (++depth == 3) {
+      entry = json::object();
+      stack.assign(1, &entry);
+      has_sharing = has_ranks = decided = rejected = false;
+      return true;
+    }
+    return depth > 3 ? open(json::object()) : true;
+  }
+  bool end_object() override {
+    if (depth == 3)
+      emit();
+    else if (depth > 3 && !stack.empty())
+      close();
+    --depth;
+    return true;
+  }
+  bool start_array(std::size_t) override {
+    if (++depth == 3 && section != SECTION_OTHER)
+      throw std::runtime_error("intent " + entry_name + " is not an object");
+    return depth > 3 ? open(json::array()) : true;
+  }
+  bool end_array() override {
+    if (depth > 3 && !stack.empty()) close();
+    --depth;
+    return true;
+  }
+  bool key(string_t& val) override {
+    if (depth == 1)
+      section = val == "files"      ? SECTION_FILES
+                : val == "datasets" ? SECTION_DATASETS
+                                    : SECTION_OTHER;
+    else if (depth == 2)
+      entry_name = val;
+    else
+      member = val;
+    if (depth == 3) field = val;
+    return true;
+  }
+  bool parse_error(std::size_t, const std::string&,
+                   const nlohmann::detail::exception& e) override {
+    throw std::runtime_error(e.what());
+  }
+};
+}  // namespace
+
+void stream_intents(std::istream& input, const DatasetSink& on_dataset,
+                    const FileSink& on_file, const IntentFilter& keep) {
+  IntentSaxHandler handler(on_dataset, on_file, keep);
+  json::sax_parse(input, &handler);
+}
+
+/* run the sinks over a file read in INTENT_STREAM_BLOCK_SIZE blocks. */
+static void stream_intents_file(const std::string& path,
+                                const DatasetSink& on_dataset,
+                                const FileSink& on_file,
+                                const IntentFilter& keep) {
+  std::vector<char> block(INTENT_STREAM_BLOCK_SIZE);
+  std::ifstream input;
+  input.rdbuf()->pubsetbuf(block.data(), block.size());
+  input.open(path, std::ios::binary);
+  if (!input.is_open()) throw std::runtime_error("cannot open " + path);
+  stream_intents(input, on_dataset, on_file, keep);
+}
+
+Intents read_intents(const std::string& path, const IntentFilter& keep) {
+  Intents intents;
+  stream_intents_file(
+      path,
+      [&intents](std::string&& name, DatasetIOIntents&& dataset) {
+        intents.datasets[std::move(name)] = std::move(dataset);
+      },
+      [&intents](std::string&& filename, FileIOIntents&& file) {
+        intents.files[std::move(filename)] = std::move(file);
+      },
+      keep);
+  return intents;
+}
+
+std::vector<char> compile_intents_file(const std::string& path,
+                                       const IntentFilter& keep) {
+  IntentImageBuilder builder;
+  stream_intents_file(
+      path,
+      [&builder](std::string&& name, DatasetIOIntents&& dataset) {
+        builder.add_dataset(name, dataset);
+      },
+      [&builder](std::string&& filename, FileIOIntents&& file) {
+        builder.add_file(filename, file);
+      },
+      keep);
+  return builder.finish();
+}
+}  // namespace h5intent
@@ -0,0 +1,49 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_INTENT_STREAM_H
+#define H5INTENT_INTENT_STREAM_H
+#include <h5intent/configuration_loader.h>
+
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+/**
+ * Streaming (SAX) reader for intent JSON files. Only the entry that is
+ * currently being parsed exists as a json value; every finished entry is
+ * converted and handed to a sink, so peak memory follows the size of the
+ * result instead of raw text + DOM + result.
+ */
+namespace h5intent {
+/* files are read through a buffer of this size. */
+static const size_t INTENT_STREAM_BLOCK_SIZE = 1 << 20;
+
+typedef std::function<void(std::string&& name, DatasetIOIntents&& intents)>
+    DatasetSink;
+typedef std::function<void(std::string&& filename, FileIOIntents&& intents)>
+    FileSink;
+/* decides from the key and sharing of an entry whether it is loaded at all. */
+typedef std::function<bool(const std::string& name, SharingPattern sharing,
+                           const RankSet& process_sharing)>
+    IntentFilter;
+
+/**
+ * Parse {"files": {...}, "datasets": {...}} from input, calling the sinks
+ * once per entry in file order. keep runs as soon as an entry's
+ * sharing_pattern and process_sharing are read (at its end if one is
+ * missing); members after them are not built for entries it rejects.
+ * Throws std::runtime_error on bad input.
+ */
+void stream_intents(std::istream& input, const DatasetSink& on_dataset,
+                    const FileSink& on_file, const IntentFilter& keep = nullptr);
+
+/* Streaming equivalent of json::parse(file).get_to(intents). */
+Intents read_intents(const std::string& path, const IntentFilter& keep = nullptr);
+
+/* Stream a JSON file straight into a compiled image. */
+std::vector<char> compile_intents_file(const std::string& path,
+                                       const IntentFilter& keep = nullptr);
+}  // namespace h5intent
+#endif  // H5INTENT_INTENT_STREAM_H
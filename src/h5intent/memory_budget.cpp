@@ -0,0 +1,106 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "memory_budget.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <string>
+
+namespace h5intent {
+static const uint64_t UNLIMITED = std::numeric_limits<uint64_t>::max();
+
+static uint64_t meminfo_available() {
+  std::ifstream meminfo("/proc/meminfo");
+  std::string key, unit;
+  uint64_t value;
+  while (meminfo >> key >> value) {
+    std::getline(meminfo, unit);
+    if (key == "MemAvailable:") return value * 1024;
+  }
+  return UNLIMITED;
+}
+
+/* a single value file; "max" or a missing file means no limit. */
+static uint64_t read_limit(const std::string& path) {
+  std::ifstream file(path);
+  std::string value;
+  if (!(file >> value) || value == "max") return UNLIMITED;
+  return std::strtoull(value.c_str(), nullptr, 10);
+}
+
+/* headroom left in this process's cgroup and in each of its ancestors,
+ * since a limit set on a parent applies to all of its children. */
+static uint64_t cgroup_available() {
+  std::ifstream self("/proc/self/cgroup");
+  std::string line, group;
+  while (std::getline(self, line))
+    if (line.compare(0, 3, "0::") == 0) group = line.substr(3);
+  if (group.empty()) return UNLIMITED;
+  uint64_t available = UNLIMITED;
+  while (!group.empty() && group != "/") {
+    auto directory = "/sys/fs/cgroup" + group;
+    uint64_t limit = read_limit(directory + "/memory.max");
+    if (limit != UNLIMITED) {
+      uint64_t current = read_limit(directory + "/memory.current");
+      if (current == UNLIMITED) current = 0;
+      available = std::min(available, limit > current ? limit - current : 0);
+    }
+    group = group.substr(0, group.find_last_of('/'));
+  }
+  return available;
+}
+
+uint64_t available_memory() {
+  uint64_t available = std::min(meminfo_available(), cgroup_available());
+  return available == UNLIMITED ? 0 : available;
+}
+
+size_t ranks_per_node() {
+  static const char* VARIABLES[] = {"H5INTENT_RANKS_PER_NODE",
+                                    "OMPI_COMM_WORLD_LOCAL_SIZE",
+                                    "MPI_LOCALNRANKS",
+                                    "PMI_LOCAL_SIZE",
+                                    "SLURM_NTASKS_PER_NODE",
+                                    "JSM_NAMESPACE_LOCAL_SIZE"};
+  for (auto variable : VARIABLES) {
+    const char* value = getenv(variable);
+    /* SLURM_NTASKS_PER_NODE may read "4(x2)", strtoul stops at the '('. */
+    size_t ranks = value == nullptr ? 0 : std::strtoul(value, nullptr, 10);
+    if (ranks > 0) return ranks;
+  }
+  return 1;
+}
+
+static uint64_t detect_budget() {
+  const char* configured = getenv("H5INTENT_MEMORY_BUDGET");
+  if (configured != nullptr) return std::strtoull(configured, nullptr, 10);
+  return (uint64_t)(available_memory() / ranks_per_node() *
+                    MEMORY_BUDGET_FRACTION);
+}
+
+MemoryBudget::MemoryBudget() : MemoryBudget(detect_budget()) {}
+
+MemoryBudget::MemoryBudget(uint64_t limit)
+    : mutex(), limit(limit), committed(0) {}
+
+uint64_t MemoryBudget::in_use() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return committed;
+}
+
+bool MemoryBudget::reserve(uint64_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (bytes > limit - committed) return false;
+  committed += bytes;
+  return true;
+}
+
+void MemoryBudget::release(uint64_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  committed -= std::min(bytes, committed);
+}
+}  // namespace h5intent
@@ -0,0 +1,49 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_MEMORY_BUDGET_H
+#define H5INTENT_MEMORY_BUDGET_H
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+/**
+ * Memory a rank may spend on core VFD files. The budget is the node's free
+ * memory (MemAvailable, capped by the cgroup v2 memory.max of this process)
+ * split evenly across the ranks of the node, of which only a fraction is
+ * handed out so the application keeps room for its own buffers. Files
+ * reserve their size when opened and release it when closed, so a rank with
+ * several open files never buffers more than its share.
+ */
+namespace h5intent {
+/* share of a rank's memory the core VFD may take. */
+static const double MEMORY_BUDGET_FRACTION = 0.5;
+
+/* MemAvailable from /proc/meminfo, capped by the cgroup limits, 0 if unknown. */
+uint64_t available_memory();
+/**
+ * Ranks sharing this node, from H5INTENT_RANKS_PER_NODE or the launcher's
+ * environment. The loader runs outside of any communicator, so this cannot
+ * ask MPI. Defaults to 1.
+ */
+size_t ranks_per_node();
+
+class MemoryBudget {
+  std::mutex mutex;
+  uint64_t limit;
+  uint64_t committed;
+
+ public:
+  /* H5INTENT_MEMORY_BUDGET (bytes) if set, else detected from the node. */
+  MemoryBudget();
+  explicit MemoryBudget(uint64_t limit);
+  uint64_t budget() const { return limit; }
+  uint64_t in_use();
+  /* whether bytes fit the budget when nothing else is reserved. */
+  bool fits(uint64_t bytes) const { return bytes <= limit; }
+  /* @return false, reserving nothing, if bytes would exceed the budget. */
+  bool reserve(uint64_t bytes);
+  void release(uint64_t bytes);
+};
+}  // namespace h5intent
+#endif  // H5INTENT_MEMORY_BUDGET_H
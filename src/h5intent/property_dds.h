@@ -36,7 +36,7 @@ struct DatasetAccessProperties {
   struct chunk {
     bool use;
     int ndims;
-    hsize_t* dim;
+    hsize_t dim[H5S_MAX_RANK]; /* owned, so copies of the properties stay valid */
     unsigned opts;
   } chunk;
   struct szip {
@@ -86,7 +86,7 @@ struct FileAccessProperties {
   struct alignment {
     bool use;
     size_t threshold;
-    hbool_t alignment_value;
+    hsize_t alignment_value;
   } alignment;
   struct core {
     bool use;
@@ -142,7 +142,11 @@ struct FileAccessProperties {
   } file_image;
   struct optimizations {
     bool use;
+    /* locking and gc_ref are only set if asked for; locking needs flock,
+     * which some Lustre and GPFS mounts do not have. */
+    bool use_file_locking;
     bool file_locking;
+    bool use_gc_ref;
     unsigned gc_ref;
     size_t sieve_buf_size;
     hsize_t small_data_block_size;
@@ -154,6 +158,7 @@ struct FileAccessProperties {
     bool enable_logging;  // H5Pset_mdc_log_options
     hsize_t meta_block_size;
     bool enable_coll_metadata_write;  // H5Pset_coll_metadata_write
+    bool enable_coll_metadata_ops;  // H5Pset_all_coll_metadata_ops
   } metadata;
   struct page_buffer {
     bool use;
@@ -207,8 +212,9 @@ struct FileProperties {
 
 #ifdef __cplusplus
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <string>
-#include <any>
+#include <h5intent/rank_set.h>
 struct HDF5Properties {
   std::unordered_map<std::string,DatasetProperties> datasets;
   std::unordered_map<std::string,FileProperties> files;
@@ -259,7 +265,20 @@ struct MultiSessionIO {
     float* write_timestamp;
 };
 
-typedef std::unordered_map<std::string, std::unordered_map<std::string, std::any>> TopAccessedSegments;
+/* Darshan keeps the three most common accesses, each with up to 5 dims. */
+static const unsigned TOP_ACCESSED_SEGMENTS = 3;
+static const unsigned SEGMENT_MAX_DIMS = 5;
+struct AccessSegment {
+    unsigned ndims;
+    hsize_t length[SEGMENT_MAX_DIMS];
+    hsize_t stride[SEGMENT_MAX_DIMS];
+    hsize_t count;
+    hsize_t access;
+};
+/* segments[0] is the most common access ("1" in the JSON). */
+struct TopAccessedSegments {
+    AccessSegment segments[TOP_ACCESSED_SEGMENTS];
+};
 
 struct DatasetIOIntents {
     std::string filename;
@@ -269,7 +288,7 @@ struct DatasetIOIntents {
     AccessPatternType type;
     TopAccessedSegments top_accessed_segments;
     std::unordered_map<std::string, size_t> transfer_size_dist;
-    std::vector<size_t> process_sharing;
+    h5intent::RankSet process_sharing;
     size_t fs_size;
     SharingPattern sharing_pattern;
     FileMode mode;
@@ -283,8 +302,10 @@ struct FileIOIntents {
     SharingPattern sharing_pattern;
     std::unordered_map<std::string, size_t> ap_distribution;
     std::unordered_map<std::string, std::unordered_map<std::string,size_t>> transfer_size_dist;
-    std::vector<size_t> process_sharing;
+    h5intent::RankSet process_sharing;
     std::unordered_map<std::string,size_t> ds_size_dist;
+    /* groups holding the file's datasets, root included; 0 if not recorded. */
+    size_t group_count;
 };
 
 struct Intents {
@@ -294,9 +315,9 @@ struct Intents {
     Intents(const Intents& other)
             : datasets(other.datasets),
               files(other.files) {}
-    Intents(const Intents&& other)
-            : datasets(other.datasets),
-              files(other.files) {}
+    Intents(Intents&& other)
+            : datasets(std::move(other.datasets)),
+              files(std::move(other.files)) {}
     Intents& operator=(const Intents& other) {
         this->datasets = other.datasets;
         this->files = other.files;
@@ -384,24 +405,13 @@ inline void from_json(const json& j, std::vector<Value>& p) {
     p = std::vector<Value>();
     p.insert(p.end(), vec.begin(), vec.end());
 }
-inline void from_json(const json& j, std::any& p) {
-    if (j.type() == json::value_t::array) {
-        auto vec = std::vector<int>();
-        from_json(j, vec);
-        p = vec;
-    } else if (j.type() == json::value_t::number_unsigned) {
-        int a;
-        j.get_to(a);
-        p = a;
-    }
-}
 template <class Key, class Value>
 inline void from_json(const json& j, std::unordered_map<Key,Value>& p) {
     //auto jmap = j.get<std::unordered_map<Key,json>>();
     p = std::unordered_map<Key,Value>();
     for (auto& el : j.items()){
-        Value val;
-        if (el.value().type() == json::value_t::object or std::is_same<Value, std::any>::value) {
+        Value val{};
+        if (el.value().type() == json::value_t::object) {
             from_json(el.value(), val);
         } else {
             el.value().get_to(val);
@@ -416,14 +426,6 @@ inline void to_json(json& j, const long unsigned int& p) {
     j = json();
     j = p;
 }
-#define ANY_CAST(lhs, rhs, TYPE) \
-if (rhs.type() == typeid(TYPE)) lhs = std::any_cast<TYPE>(rhs);
-inline void to_json(json& j, const std::any& p) {
-    j = json();
-    ANY_CAST(j,p,int);
-    ANY_CAST(j,p,size_t);
-    ANY_CAST(j,p,std::vector<int>);
-}
 template <class Key, class Value>
 inline void to_json(json& j, const std::unordered_map<Key,Value>& p) {
     j = json();
@@ -440,6 +442,70 @@ inline void to_json(json& j, const std::vector<Value>& p) {
 
 }
 
+/* {"ranges": [[first, last], ...]}; plain rank arrays are still accepted. */
+inline void to_json(json& j, const h5intent::RankSet& p) {
+    j = json();
+    j["ranges"] = json::array();
+    for (const auto& range : p.ranges()) {
+        j["ranges"].push_back({range.first, range.second});
+    }
+}
+inline void from_json(const json& j, h5intent::RankSet& p) {
+    p = h5intent::RankSet();
+    if (j.is_array()) {
+        for (const auto& rank : j) p.add(rank.get<uint32_t>());
+        return;
+    }
+    if (j.contains("ranges")) {
+        for (const auto& range : j.at("ranges")) {
+            p.add_range(range.at(0).get<uint32_t>(), range.at(1).get<uint32_t>());
+        }
+    }
+    if (j.contains("ranks")) {
+        for (const auto& rank : j.at("ranks")) p.add(rank.get<uint32_t>());
+    }
+}
+
+/* {"1": {"length": [...], "stride": [...], "count": n, "access": n}, ...} */
+inline void to_json(json& j, const TopAccessedSegments& p) {
+    j = json::object();
+    for (unsigned s = 0; s < TOP_ACCESSED_SEGMENTS; ++s) {
+        const auto& segment = p.segments[s];
+        auto& entry = j[std::to_string(s + 1)];
+        entry["length"] = json::array();
+        entry["stride"] = json::array();
+        for (unsigned d = 0; d < segment.ndims; ++d) {
+            entry["length"].push_back(segment.length[d]);
+            entry["stride"].push_back(segment.stride[d]);
+        }
+        entry["count"] = segment.count;
+        entry["access"] = segment.access;
+    }
+}
+inline void from_json(const json& j, TopAccessedSegments& p) {
+    p = TopAccessedSegments();
+    for (const auto& el : j.items()) {
+        const auto& key = el.key();
+        if (key.size() != 1 || key[0] < '1' || key[0] >= '1' + (int)TOP_ACCESSED_SEGMENTS) continue;
+        auto& segment = p.segments[key[0] - '1'];
+        const auto& value = el.value();
+        auto length = value.find("length");
+        if (length != value.end()) {
+            segment.ndims = std::min<size_t>(length->size(), SEGMENT_MAX_DIMS);
+            for (unsigned d = 0; d < segment.ndims; ++d) segment.length[d] = (*length)[d].get<hsize_t>();
+        }
+        auto stride = value.find("stride");
+        if (stride != value.end()) {
+            for (unsigned d = 0; d < segment.ndims && d < stride->size(); ++d)
+                segment.stride[d] = (*stride)[d].get<hsize_t>();
+        }
+        auto count = value.find("count");
+        if (count != value.end()) segment.count = count->get<hsize_t>();
+        auto access = value.find("access");
+        if (access != value.end()) segment.access = access->get<hsize_t>();
+    }
+}
+
 inline void to_json(json& j, const MultiSessionIO& p) {
     j = json();
     TO_JSON_D_ARRAY_FIXED(open_timestamp, 2);
@@ -495,6 +561,7 @@ inline void to_json(json& j, const FileIOIntents& p) {
     TO_JSON_D_OBJ(transfer_size_dist);
     TO_JSON_D_OBJ(process_sharing);
     TO_JSON_D_OBJ(ds_size_dist);
+    TO_JSON_D(group_count);
 }
 inline void from_json(const json& j, FileIOIntents& p) {
     FROM_JSON_D(filename);
@@ -506,6 +573,7 @@ inline void from_json(const json& j, FileIOIntents& p) {
     FROM_JSON_D_OBJ(transfer_size_dist);
     FROM_JSON_D_OBJ(process_sharing);
     FROM_JSON_D_OBJ(ds_size_dist);
+    FROM_JSON_D(group_count);
 }
 inline void to_json(json& j, const Intents& p) {
   j = json();
@@ -0,0 +1,122 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "rank_set.h"
+
+#include <algorithm>
+
+namespace h5intent {
+RankSet::RankSet(std::initializer_list<uint32_t> ranks) : RankSet() {
+  for (auto rank : ranks) add(rank);
+}
+
+RankSet::Container& RankSet::container(uint16_t key) {
+  auto iter = std::lower_bound(
+      containers.begin(), containers.end(), key,
+      [](const Container& container, uint16_t key) { return container.key < key; });
+  if (iter == containers.end() || iter->key != key)
+    iter = containers.insert(iter, Container{key, 0, {}, {}});
+  return *iter;
+}
+
+void RankSet::add_to_container(Container& container, uint16_t first,
+                               uint16_t last) {
+  if (!container.bitmap.empty()) {
+    for (uint32_t bit = first; bit <= last; ++bit) {
+      uint64_t mask = 1ULL << (bit & 63);
+      if (container.bitmap[bit >> 6] & mask) continue;
+      container.bitmap[bit >> 6] |= mask;
+      container.cardinality++;
+    }
+    return;
+  }
+  auto& runs = container.runs;
+  /* merge with every run that overlaps or touches [first, last]. */
+  auto begin = std::lower_bound(
+      runs.begin(), runs.end(), first,
+      [](const std::pair<uint16_t, uint16_t>& run, uint16_t first) {
+        return (uint32_t)run.second + 1 < first;
+      });
+  auto end = begin;
+  uint32_t merged_first = first, merged_last = last;
+  while (end != runs.end() && end->first <= (uint32_t)last + 1) {
+    merged_first = std::min<uint32_t>(merged_first, end->first);
+    merged_last = std::max<uint32_t>(merged_last, end->second);
+    container.cardinality -= end->second - end->first + 1;
+    ++end;
+  }
+  container.cardinality += merged_last - merged_first + 1;
+  begin = runs.erase(begin, end);
+  runs.insert(begin, {(uint16_t)merged_first, (uint16_t)merged_last});
+  if (runs.size() <= MAX_RUNS) return;
+  container.bitmap.assign(BITMAP_WORDS, 0);
+  for (const auto& run : runs)
+    for (uint32_t bit = run.first; bit <= run.second; ++bit)
+      container.bitmap[bit >> 6] |= 1ULL << (bit & 63);
+  runs.clear();
+  runs.shrink_to_fit();
+}
+
+void RankSet::add_range(uint32_t first, uint32_t last) {
+  if (first > last) std::swap(first, last);
+  uint64_t low = first;
+  while (low <= last) {
+    uint16_t key = (uint16_t)(low >> CONTAINER_BITS);
+    uint64_t container_last = ((uint64_t)key << CONTAINER_BITS) | 0xFFFF;
+    uint64_t high = std::min<uint64_t>(last, container_last);
+    auto& target = container(key);
+    cardinality -= target.cardinality;
+    add_to_container(target, (uint16_t)low, (uint16_t)high);
+    cardinality += target.cardinality;
+    low = high + 1;
+  }
+}
+
+bool RankSet::contains(uint32_t rank) const {
+  uint16_t key = (uint16_t)(rank >> CONTAINER_BITS), low = (uint16_t)rank;
+  auto iter = std::lower_bound(
+      containers.begin(), containers.end(), key,
+      [](const Container& container, uint16_t key) { return container.key < key; });
+  if (iter == containers.end() || iter->key != key) return false;
+  if (!iter->bitmap.empty()) return (iter->bitmap[low >> 6] >> (low & 63)) & 1;
+  auto run = std::upper_bound(
+      iter->runs.begin(), iter->runs.end(), low,
+      [](uint16_t low, const std::pair<uint16_t, uint16_t>& run) {
+        return low < run.first;
+      });
+  return run != iter->runs.begin() && (run - 1)->second >= low;
+}
+
+std::vector<RankSet::Range> RankSet::ranges() const {
+  std::vector<Range> result;
+  auto append = [&result](uint32_t first, uint32_t last) {
+    if (!result.empty() && result.back().second + 1 == first)
+      result.back().second = last;
+    else
+      result.emplace_back(first, last);
+  };
+  for (const auto& container : containers) {
+    uint32_t base = (uint32_t)container.key << CONTAINER_BITS;
+    for (const auto& run : container.runs)
+      append(base | run.first, base | run.second);
+    if (container.bitmap.empty()) continue;
+    for (uint32_t bit = 0; bit < (1u << CONTAINER_BITS);) {
+      if (!((container.bitmap[bit >> 6] >> (bit & 63)) & 1)) {
+        ++bit;
+        continue;
+      }
+      uint32_t first = bit;
+      while (bit < (1u << CONTAINER_BITS) &&
+             ((container.bitmap[bit >> 6] >> (bit & 63)) & 1))
+        ++bit;
+      append(base | first, base | (bit - 1));
+    }
+  }
+  return result;
+}
+
+bool RankSet::operator==(const RankSet& other) const {
+  return cardinality == other.cardinality && ranges() == other.ranges();
+}
+}  // namespace h5intent
@@ -0,0 +1,59 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_RANK_SET_H
+#define H5INTENT_RANK_SET_H
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+/**
+ * Set of MPI ranks, e.g. the process_sharing of an intent.
+ *
+ * Ranks are split into containers of 2^16 by their high bits (as in roaring
+ * bitmaps). A container holds sorted, disjoint runs, so a collective
+ * dataset on 5120 ranks is one [0, 5119] run, and switches to a 8 KB bitmap
+ * once the runs would take more space than that. The cardinality is kept up
+ * to date on insert, so size() is O(1).
+ */
+namespace h5intent {
+class RankSet {
+ public:
+  typedef std::pair<uint32_t, uint32_t> Range; /* inclusive [first, last] */
+
+ private:
+  static const uint32_t CONTAINER_BITS = 16;
+  static const uint32_t BITMAP_WORDS = (1u << CONTAINER_BITS) / 64;
+  /* a run costs 4 bytes, past this a bitmap is smaller. */
+  static const size_t MAX_RUNS = BITMAP_WORDS * 8 / 4;
+  struct Container {
+    uint16_t key;
+    uint32_t cardinality;
+    std::vector<std::pair<uint16_t, uint16_t>> runs;
+    std::vector<uint64_t> bitmap; /* empty unless the container is a bitmap */
+  };
+  std::vector<Container> containers;
+  size_t cardinality;
+
+  Container& container(uint16_t key);
+  static void add_to_container(Container& container, uint16_t first,
+                               uint16_t last);
+
+ public:
+  RankSet() : containers(), cardinality(0) {}
+  RankSet(std::initializer_list<uint32_t> ranks);
+  /* insert [first, last], both inclusive. */
+  void add_range(uint32_t first, uint32_t last);
+  void add(uint32_t rank) { add_range(rank, rank); }
+  size_t size() const { return cardinality; }
+  bool empty() const { return cardinality == 0; }
+  bool contains(uint32_t rank) const;
+  /* maximal runs in ascending order. */
+  std::vector<Range> ranges() const;
+  bool operator==(const RankSet& other) const;
+  bool operator!=(const RankSet& other) const { return !(*this == other); }
+};
+}  // namespace h5intent
+#endif  // H5INTENT_RANK_SET_H
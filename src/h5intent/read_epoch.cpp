@@ -0,0 +1,80 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "read_epoch.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace h5intent {
+namespace {
+struct alignas(64) ReaderSlot {
+  std::atomic<uint64_t> epoch; /* 0 while the owner is not reading */
+  std::atomic<bool> in_use;
+  ReaderSlot() : epoch(0), in_use(false) {}
+};
+std::atomic<uint64_t> global_epoch(1);
+/* never destroyed, threads may still read while statics are torn down. */
+std::mutex& slots_mutex() {
+  static auto* mutex = new std::mutex();
+  return *mutex;
+}
+/* a deque keeps slot addresses stable while it grows. */
+std::deque<ReaderSlot>& slots() {
+  static auto* slots = new std::deque<ReaderSlot>();
+  return *slots;
+}
+
+struct ThreadSlot {
+  ReaderSlot* slot;
+  unsigned depth;
+  ThreadSlot() : slot(nullptr), depth(0) {}
+  ~ThreadSlot() {
+    if (slot != nullptr) slot->in_use.store(false, std::memory_order_release);
+  }
+  /* once per thread; slots of finished threads are reused. */
+  ReaderSlot* get() {
+    if (slot != nullptr) return slot;
+    std::lock_guard<std::mutex> lock(slots_mutex());
+    for (auto& candidate : slots()) {
+      if (!candidate.in_use.load(std::memory_order_relaxed)) {
+        slot = &candidate;
+        break;
+      }
+    }
+    if (slot == nullptr) slot = &slots().emplace_back();
+    slot->in_use.store(true, std::memory_order_relaxed);
+    return slot;
+  }
+};
+thread_local ThreadSlot thread_slot;
+}  // namespace
+
+ReadEpoch::Guard::Guard() {
+  if (thread_slot.depth++ > 0) return;
+  /* seq_cst orders the announcement before the caller's pointer load. */
+  thread_slot.get()->epoch.store(global_epoch.load(std::memory_order_seq_cst),
+                                 std::memory_order_seq_cst);
+}
+
+ReadEpoch::Guard::~Guard() {
+  if (--thread_slot.depth > 0) return;
+  thread_slot.slot->epoch.store(0, std::memory_order_release);
+}
+
+uint64_t ReadEpoch::retire() {
+  return global_epoch.fetch_add(1, std::memory_order_seq_cst);
+}
+
+uint64_t ReadEpoch::oldest_reader() {
+  uint64_t oldest = UINT64_MAX;
+  std::lock_guard<std::mutex> lock(slots_mutex());
+  for (const auto& slot : slots()) {
+    uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+    if (epoch != 0 && epoch < oldest) oldest = epoch;
+  }
+  return oldest;
+}
+}  // namespace h5intent
@@ -0,0 +1,36 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_READ_EPOCH_H
+#define H5INTENT_READ_EPOCH_H
+#include <cstdint>
+/**
+ * Epoch based reclamation for published snapshots, a minimal userspace RCU.
+ *
+ * A reader announces the global epoch in a cache line of its own before it
+ * loads a published pointer. A writer that replaces a pointer calls retire()
+ * and may free the old object once oldest_reader() is past the returned
+ * epoch. Readers never block and never write to a shared cache line.
+ */
+namespace h5intent {
+class ReadEpoch {
+ public:
+  /* read-side critical section, may be nested within a thread. */
+  class Guard {
+   public:
+    Guard();
+    ~Guard();
+    Guard(const Guard& other) = delete;
+    Guard& operator=(const Guard& other) = delete;
+  };
+  /**
+   * Call after the pointer was replaced (with a seq_cst store).
+   * @return epoch the replaced object is retired at.
+   */
+  static uint64_t retire();
+  /* lowest announced epoch, UINT64_MAX when no thread is reading. */
+  static uint64_t oldest_reader();
+};
+}  // namespace h5intent
+#endif  // H5INTENT_READ_EPOCH_H
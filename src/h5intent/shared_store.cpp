@@ -0,0 +1,176 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "shared_store.h"
+
+#include <fcntl.h>
+#include <mpi.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "intent_reader.h"
+
+namespace h5intent {
+static const size_t SHARED_NAME_LENGTH = 64;
+
+static size_t align64(size_t value) { return (value + 63) & ~size_t(63); }
+
+static std::shared_ptr<const char> map_segment(const char* name, size_t size) {
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) return nullptr;
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) return nullptr;
+  return std::shared_ptr<const char>(
+      (const char*)mapped,
+      [size](const char* ptr) { munmap((void*)ptr, size); });
+}
+
+/**
+ * Copy the image and the compiled tables of a private snapshot into a new
+ * segment. The property structs are plain data (their pointer members are
+ * never set by the loader), so they are valid in every process.
+ * @return size of the segment or 0 on failure.
+ */
+static size_t create_segment(const char* name, const char* image,
+                             size_t image_size, const IntentSnapshot& local) {
+  SharedStoreHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SHARED_STORE_MAGIC, sizeof(header.magic));
+  header.image_offset = align64(sizeof(SharedStoreHeader));
+  header.image_size = image_size;
+  header.dataset_offset = align64(header.image_offset + image_size);
+  header.dataset_count = local.dataset_count();
+  header.file_offset = align64(header.dataset_offset +
+                               header.dataset_count * sizeof(DatasetProperties));
+  header.file_count = local.file_count();
+  header.total_size = header.file_offset + header.file_count * sizeof(FileProperties);
+
+  int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) return 0;
+  if (ftruncate(fd, header.total_size) != 0) {
+    close(fd);
+    shm_unlink(name);
+    return 0;
+  }
+  void* mapped =
+      mmap(nullptr, header.total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    shm_unlink(name);
+    return 0;
+  }
+  char* segment = (char*)mapped;
+  memcpy(segment, &header, sizeof(header));
+  memcpy(segment + header.image_offset, image, image_size);
+  /* ranks of the node only map the tables, so the leader fills all of them. */
+  auto datasets = (DatasetProperties*)(segment + header.dataset_offset);
+  for (size_t i = 0; i < header.dataset_count; ++i) datasets[i] = *local.dataset(i);
+  auto files = (FileProperties*)(segment + header.file_offset);
+  for (size_t i = 0; i < header.file_count; ++i) files[i] = *local.file(i);
+  munmap(mapped, header.total_size);
+  return header.total_size;
+}
+
+static std::shared_ptr<const IntentSnapshot> attach_segment(
+    std::shared_ptr<const char> mapping, size_t size) {
+  auto header = (const SharedStoreHeader*)mapping.get();
+  if (size < sizeof(SharedStoreHeader) ||
+      memcmp(header->magic, SHARED_STORE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->total_size != size)
+    throw std::runtime_error("shared intent store is corrupt");
+  auto base = mapping.get();
+  std::shared_ptr<const char> image(mapping, base + header->image_offset);
+  auto snapshot = std::make_shared<const IntentSnapshot>(
+      image, header->image_size,
+      (const DatasetProperties*)(base + header->dataset_offset),
+      (const FileProperties*)(base + header->file_offset));
+  if (snapshot->dataset_count() != header->dataset_count ||
+      snapshot->file_count() != header->file_count)
+    throw std::runtime_error("shared intent store does not match its image");
+  return snapshot;
+}
+
+std::shared_ptr<const IntentSnapshot> load_shared_snapshot(
+    const std::string& path, MPI_Comm comm) {
+  if (!active_communicator(comm)) {
+    INTENT_LOGINFO("no active communicator, reading conf %s on this rank",
+                   path.c_str());
+    size_t size = 0;
+    auto storage = read_intent_image(path, size);
+    if (storage == nullptr) return nullptr;
+    return std::make_shared<const IntentSnapshot>(storage, size);
+  }
+  int comm_size, world_size;
+  MPI_Comm_size(comm, &comm_size);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+  if (comm_size < world_size)
+    INTENT_LOGWARN("sharing conf %s over %d of %d ranks, other ranks on the "
+                   "node keep their own segment", path.c_str(), comm_size,
+                   world_size);
+  /* split from the job, so all ranks of a node map one segment. */
+  MPI_Comm node_comm, leader_comm;
+  int node_rank;
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+  MPI_Comm_rank(node_comm, &node_rank);
+  MPI_Comm_split(comm, node_rank == 0 ? 0 : MPI_UNDEFINED, 0, &leader_comm);
+
+  /* only node leaders take part in the read, the others wait for the name. */
+  std::shared_ptr<const IntentSnapshot> local;
+  char name[SHARED_NAME_LENGTH] = {0};
+  uint64_t segment_size = 0;
+  if (leader_comm != MPI_COMM_NULL) {
+    size_t image_size = 0;
+    auto image = broadcast_intent_image(path, image_size, leader_comm);
+    MPI_Comm_free(&leader_comm);
+    if (image != nullptr) {
+      local = std::make_shared<const IntentSnapshot>(image, image_size);
+      snprintf(name, sizeof(name), "/h5intent.%d.%p", getpid(),
+               (const void*)local.get());
+      segment_size = create_segment(name, image.get(), image_size, *local);
+      if (segment_size == 0) {
+        INTENT_LOGWARN("could not create shared intent store %s: %s", name,
+                       strerror(errno));
+        name[0] = '\0';
+      }
+    }
+  }
+  MPI_Bcast(&segment_size, 1, MPI_UINT64_T, 0, node_comm);
+  MPI_Bcast(name, sizeof(name), MPI_CHAR, 0, node_comm);
+
+  std::shared_ptr<const IntentSnapshot> snapshot;
+  if (segment_size == 0) {
+    /* no segment on this node: behave like LOAD_NODE. */
+    size_t size = 0;
+    auto storage = broadcast_intent_image(path, size, node_comm);
+    MPI_Comm_free(&node_comm);
+    if (storage == nullptr) return nullptr;
+    return std::make_shared<const IntentSnapshot>(storage, size);
+  }
+  try {
+    auto mapping = map_segment(name, segment_size);
+    if (mapping == nullptr)
+      throw std::runtime_error(std::string("cannot map ") + name);
+    snapshot = attach_segment(mapping, segment_size);
+  } catch (const std::exception& e) {
+    INTENT_LOGWARN("using a private copy of conf %s: %s", path.c_str(),
+                   e.what());
+  }
+  /* every rank has mapped the segment (or given up), the name can go. */
+  MPI_Barrier(node_comm);
+  if (node_rank == 0) shm_unlink(name);
+  MPI_Comm_free(&node_comm);
+  if (snapshot == nullptr) {
+    size_t size = 0;
+    auto storage = read_intent_image(path, size);
+    if (storage != nullptr)
+      snapshot = std::make_shared<const IntentSnapshot>(storage, size);
+  }
+  return snapshot;
+}
+}  // namespace h5intent
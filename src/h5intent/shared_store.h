@@ -0,0 +1,53 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_SHARED_STORE_H
+#define H5INTENT_SHARED_STORE_H
+#include <h5intent/configuration_loader.h>
+#include <mpi.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+/**
+ * Node-level intent store. One POSIX shared memory segment per node holds
+ * the compiled image followed by the compiled property tables:
+ *
+ *    SharedStoreHeader
+ *    compiled image             (64-byte aligned)
+ *    DatasetProperties[dataset_count]
+ *    FileProperties[file_count]
+ *
+ * The node leader fills the segment, every rank of the node (the leader
+ * included) maps it read-only and the name is unlinked once all ranks are
+ * attached, so the memory goes away with the last mapping.
+ */
+namespace h5intent {
+static const char SHARED_STORE_MAGIC[8] = {'H', '5', 'I', 'N',
+                                           'T', 'S', 'H', 'M'};
+
+struct SharedStoreHeader {
+  char magic[8];
+  uint64_t total_size;
+  uint64_t image_offset;
+  uint64_t image_size;
+  uint64_t dataset_offset;
+  uint64_t dataset_count;
+  uint64_t file_offset;
+  uint64_t file_count;
+};
+
+/**
+ * Collective over comm, which should span the job (ConfigurationManager
+ * passes its copy of MPI_COMM_WORLD): the node communicator is split from
+ * it, so a comm that leaves out ranks of a node gives that node one segment
+ * per such comm. Rank 0 of comm reads the configuration, the first rank of
+ * comm on each node receives it and publishes it in shared memory.
+ * @return snapshot backed by the node segment, a private snapshot if shared
+ * memory is unavailable, or nullptr if the configuration could not be read.
+ */
+std::shared_ptr<const IntentSnapshot> load_shared_snapshot(
+    const std::string& path, MPI_Comm comm);
+}  // namespace h5intent
+#endif  // H5INTENT_SHARED_STORE_H
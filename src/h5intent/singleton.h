@@ -4,12 +4,12 @@
 
 #ifndef H5INTENT_SINGLETON_H
 #define H5INTENT_SINGLETON_H
-#include <iostream>
-#include <memory>
+#include <atomic>
+#include <mutex>
 #include <utility>
 /**
  * Make a class singleton when used with the class. format for class name T
- * Singleton<T>::GetInstance()
+ * Singleton<T>::get_instance()
  * @tparam T
  */
 namespace h5intent {
@@ -20,15 +20,22 @@ class Singleton {
    * Members of Singleton Class
    */
   /**
-   * Uses unique pointer to build a static global instance of variable.
+   * Builds the instance exactly once, even when called from many threads;
+   * the arguments of the first call win. After that a lookup is a single
+   * acquire load with no locking or reference counting.
    * @tparam T
-   * @return instance of T
+   * @return instance of T, valid until the process exits.
    */
   template <typename... Args>
-  static std::shared_ptr<T> get_instance(Args... args) {
-    if (instance == nullptr)
-      instance = std::shared_ptr<T>(new T(std::forward<Args>(args)...));
-    return instance;
+  static T* get_instance(Args&&... args) {
+    T* current = instance.load(std::memory_order_acquire);
+    if (current != nullptr) return current;
+    std::call_once(created, [&]() {
+      /* never deleted, atexit handlers (e.g. H5close) may still need it. */
+      instance.store(new T(std::forward<Args>(args)...),
+                     std::memory_order_release);
+    });
+    return instance.load(std::memory_order_acquire);
   }
 
   /**
@@ -42,11 +49,14 @@ class Singleton {
   Singleton(const Singleton&) = delete; /* deleting copy constructor. */
 
  protected:
-  static std::shared_ptr<T> instance;
+  static std::atomic<T*> instance;
+  static std::once_flag created;
   Singleton() {} /* hidden default constructor. */
 };
 
 template <typename T>
-std::shared_ptr<T> Singleton<T>::instance = nullptr;
+std::atomic<T*> Singleton<T>::instance{nullptr};
+template <typename T>
+std::once_flag Singleton<T>::created;
 }  // namespace h5intent
 #endif  // H5INTENT_SINGLETON_H
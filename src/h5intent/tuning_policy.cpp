@@ -0,0 +1,526 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include "tuning_policy.h"
+
+#include <dlfcn.h>
+#include <h5intent/configuration_loader.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "chunk_solver.h"
+#include "cost_model.h"
+#include "memory_budget.h"
+#include "singleton.h"
+
+namespace h5intent {
+SystemFacts system_facts(const std::string& filename) {
+  return {detect_filesystem(filename),
+          Singleton<MemoryBudget>::get_instance()->budget(), ranks_per_node()};
+}
+
+/* transfers of the file's most common dataset size, 0 if unknown. */
+static uint64_t transfer_count(const FileIOIntents& intents) {
+  auto dist = intents.transfer_size_dist.find("1");
+  if (dist == intents.transfer_size_dist.end()) return 0;
+  auto count = dist->second.find("count");
+  return count == dist->second.end() ? 0 : count->second;
+}
+
+/* mean transfer of the file's most common dataset size, 0 if unknown. */
+static uint64_t mean_transfer_size(const FileIOIntents& intents) {
+  uint64_t count = transfer_count(intents);
+  if (count == 0) return 0;
+  auto sum = intents.transfer_size_dist.at("1").find("sum");
+  return sum == intents.transfer_size_dist.at("1").end() ? 0 : sum->second / count;
+}
+
+/* mean dataset size of the file, 0 if unknown. */
+static uint64_t mean_dataset_size(const FileIOIntents& intents) {
+  auto sum = intents.ds_size_dist.find("sum"), count = intents.ds_size_dist.find("count");
+  if (sum == intents.ds_size_dist.end() || count == intents.ds_size_dist.end() ||
+      count->second == 0)
+    return 0;
+  return sum->second / count->second;
+}
+
+static uint64_t most_common_transfer_size(const DatasetIOIntents& intents) {
+  auto dist = intents.transfer_size_dist.find("1");
+  return dist == intents.transfer_size_dist.end() ? 0 : dist->second;
+}
+
+static void set_transfer_mode(DatasetProperties& properties,
+                              const DatasetIOIntents& intents, bool collective,
+                              unsigned chunks_per_process) {
+  properties.transfer.dmpiio.use = collective;
+  if (!collective) return;
+  properties.transfer.dmpiio.xfer_mode = H5FD_MPIO_COLLECTIVE;
+  properties.transfer.dmpiio.coll_opt_mode = H5FD_MPIO_COLLECTIVE_IO;
+  properties.transfer.dmpiio.chunk_opt_mode = H5FD_MPIO_CHUNK_ONE_IO;
+  properties.transfer.dmpiio.num_chunk_per_proc = chunks_per_process;
+  /* a chunk goes collective once one of its sharing processes touches it,
+   * rounded up since HDF5 takes whole percents. */
+  size_t processes = std::max<size_t>(1, intents.process_sharing.size());
+  properties.transfer.dmpiio.percent_num_proc_per_chunk =
+      (unsigned)((100 + processes - 1) / processes);
+}
+
+static void set_chunk_cache(DatasetProperties& properties,
+                            const ChunkConstraints& constraints,
+                            const hsize_t* chunk, const DatasetIOIntents& intents,
+                            const SystemFacts& facts, bool chunked) {
+  properties.access.chunk_cache.use = chunked;
+  if (!chunked) return;
+  auto plan = plan_chunk_cache(constraints, chunk, intents.type, facts.memory_budget);
+  properties.access.chunk_cache.rdcc_nslots = plan.nslots;
+  properties.access.chunk_cache.rdcc_nbytes = plan.nbytes;
+  properties.access.chunk_cache.rdcc_w0 = plan.w0;
+  INTENT_LOGINFO("Chunk cache for dataset %s has %lu bytes in %lu slots",
+                 intents.dataset_name.c_str(), (unsigned long)plan.nbytes,
+                 (unsigned long)plan.nslots)
+}
+
+HeuristicPolicy::HeuristicPolicy(TuningThresholds thresholds)
+    : thresholds(thresholds) {}
+
+DatasetProperties HeuristicPolicy::dataset_properties(
+    const DatasetIOIntents& intents, const SystemFacts& facts) const {
+  return dataset_properties(intents, facts, thresholds);
+}
+
+FileProperties HeuristicPolicy::file_properties(const FileIOIntents& intents,
+                                                const SystemFacts& facts) const {
+  return file_properties(intents, facts, thresholds);
+}
+
+DatasetProperties HeuristicPolicy::dataset_properties(
+    const DatasetIOIntents& intents, const SystemFacts& facts,
+    const TuningThresholds& thresholds) {
+  auto properties = DatasetProperties();
+  bool enable_chunking = true;
+  auto most_common_ts = most_common_transfer_size(intents);
+  size_t ndims = std::min<size_t>(intents.ndims, H5S_MAX_RANK);
+  hsize_t chunks[H5S_MAX_RANK] = {0};
+  if (most_common_ts > thresholds.max_chunked_transfer) enable_chunking = false;
+  /* the dataspace is not known yet; the VOL solves again at create time. */
+  auto constraints = intent_constraints(intents, facts.filesystem.io_size());
+  if (enable_chunking) enable_chunking = solve_chunk_shape(constraints, chunks);
+  set_chunk_cache(properties, constraints, chunks, intents, facts, enable_chunking);
+  properties.access.chunk.use = enable_chunking;
+  properties.access.chunk.ndims = (int)ndims;
+  for (size_t d = 0; d < ndims; ++d) properties.access.chunk.dim[d] = chunks[d];
+  INTENT_LOGINFO("Chunk for dataset %s has size %d",
+                 intents.dataset_name.c_str(), chunks[0])
+  set_transfer_mode(properties, intents, intents.process_sharing.size() > 1,
+                    thresholds.chunks_per_process);
+  return properties;
+}
+
+/**
+ * Paged file space with a page buffer, for files written in pieces well below
+ * a block of a shared filesystem and too far apart for the sieve buffer
+ * (sieve bytes) to gather them: HDF5 then keeps the pages written to in
+ * memory and writes them whole. A page holds PAGE_TRANSFERS mean transfers, up to a block; the
+ * buffer holds the pages of a mean dataset, up to its share of the memory
+ * budget.
+ */
+static void set_page_buffer(FileProperties& properties, const FileIOIntents& intents,
+                            const SystemFacts& facts,
+                            const TuningThresholds& thresholds, uint64_t sieve) {
+  uint64_t transfer = mean_transfer_size(intents);
+  uint64_t max_page = std::max<uint64_t>(
+      std::min<uint64_t>(facts.filesystem.io_size(), thresholds.max_block_size),
+      MIN_PAGE_SIZE);
+  if (!thresholds.page_buffer || transfer == 0 || transfer * 2 > max_page) return;
+  if (intents.fs_size / transfer_count(intents) <= sieve) return;
+  /* the kernel page cache already gathers them on local filesystems, where
+   * the page buffer only adds a read of each page it fills. */
+  if (!facts.filesystem.is_parallel() && facts.filesystem.type != FS_NFS) return;
+  uint64_t page = MIN_PAGE_SIZE;
+  while (page * 2 <= max_page && page < transfer * PAGE_TRANSFERS) page *= 2;
+  uint64_t dataset = mean_dataset_size(intents);
+  uint64_t working = dataset > 0 ? dataset : intents.fs_size;
+  uint64_t limit = facts.memory_budget > 0
+                       ? facts.memory_budget / PAGE_BUFFER_BUDGET_SHARE
+                       : PAGE_BUFFER_DEFAULT_BYTES;
+  uint64_t buffer = std::min((working + page - 1) / page * page, limit / page * page);
+  if (buffer < page) return;
+  /* a metadata page for each dataset's header and index, raw data keeps
+   * at least the other half of the pages. */
+  auto datasets = intents.ds_size_dist.find("count");
+  uint64_t objects = datasets == intents.ds_size_dist.end() ? 1 : datasets->second;
+  uint64_t pages = buffer / page;
+  unsigned min_meta = (unsigned)std::min<uint64_t>(
+      (100 * objects + pages - 1) / pages, 100 - PAGE_BUFFER_MIN_RAW);
+  properties.creation.file_space = {true, page, H5F_FSPACE_STRATEGY_PAGE, false, 1};
+  properties.access.page_buffer = {true, buffer, min_meta, PAGE_BUFFER_MIN_RAW};
+  INTENT_LOGINFO("Page size %d and page buffer %d for file %s", page, buffer,
+                 intents.filename.c_str())
+}
+
+H5AC_cache_config_t default_metadata_cache() {
+  H5AC_cache_config_t config;
+  memset(&config, 0, sizeof(config));
+  config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+  config.evictions_enabled = true;
+  config.set_initial_size = true;
+  config.initial_size = METADATA_CACHE_INITIAL_SIZE;
+  config.min_clean_fraction = 0.3;
+  config.max_size = METADATA_CACHE_MAX_SIZE;
+  config.min_size = 1024 * 1024;
+  config.epoch_length = 50000;
+  config.incr_mode = H5C_incr__threshold;
+  config.lower_hr_threshold = 0.9;
+  config.increment = 2.0;
+  config.apply_max_increment = true;
+  config.max_increment = 4 * 1024 * 1024;
+  config.flash_incr_mode = H5C_flash_incr__add_space;
+  config.flash_multiple = 1.0;
+  config.flash_threshold = 0.25;
+  config.decr_mode = H5C_decr__age_out_with_threshold;
+  config.upper_hr_threshold = 0.999;
+  config.decrement = 0.9;
+  config.apply_max_decrement = true;
+  config.max_decrement = 1024 * 1024;
+  config.epochs_before_eviction = 3;
+  config.apply_empty_reserve = true;
+  config.empty_reserve = 0.1;
+  config.dirty_bytes_threshold = 256 * 1024;
+  config.metadata_write_strategy = H5AC_METADATA_WRITE_STRATEGY__DISTRIBUTED;
+  return config;
+}
+
+/**
+ * Metadata cache for files whose objects do not fit HDF5's default one, so a
+ * pass over all datasets (every timestep, or every reopen) finds their
+ * headers and indexes cached instead of reading them again. The cache starts
+ * at the objects' metadata and never shrinks below it; it may grow to twice
+ * that, in steps of up to half, within its share of the memory budget.
+ * Epochs span a pass over the objects so the hit rate and age-out see whole
+ * passes. An entry as large as a group's share of the metadata grows the
+ * cache at once (twice that when writing, as the group keeps growing), and
+ * entries only age out after a pass without a miss, keeping a group's share
+ * empty for the objects a writer adds.
+ */
+static void set_metadata_cache(FileProperties& properties, const FileIOIntents& intents,
+                               const SystemFacts& facts,
+                               const TuningThresholds& thresholds) {
+  auto datasets = intents.ds_size_dist.find("count");
+  uint64_t dataset_count = datasets == intents.ds_size_dist.end() ? 0 : datasets->second;
+  uint64_t objects = dataset_count + intents.group_count;
+  uint64_t working = dataset_count * METADATA_BYTES_PER_DATASET +
+                     intents.group_count * METADATA_BYTES_PER_GROUP;
+  if (!thresholds.metadata_cache || working <= METADATA_CACHE_INITIAL_SIZE) return;
+  uint64_t limit = METADATA_CACHE_LIMIT;
+  if (facts.memory_budget > 0)
+    limit = std::min(limit, facts.memory_budget / METADATA_CACHE_BUDGET_SHARE);
+  limit = std::max(limit, METADATA_CACHE_INITIAL_SIZE);
+  auto config = default_metadata_cache();
+  config.initial_size = std::min(working, limit);
+  config.min_size = config.initial_size;
+  config.max_size = std::min(std::max(2 * working, METADATA_CACHE_MAX_SIZE), limit);
+  config.max_increment = std::max<size_t>(config.max_increment, working / 2);
+  config.epoch_length = (long)std::min<uint64_t>(
+      std::max<uint64_t>(objects * METADATA_ACCESSES_PER_OBJECT, config.epoch_length),
+      METADATA_CACHE_MAX_EPOCH);
+  bool read_only = intents.mode == FileMode::FILE_READ_ONLY;
+  uint64_t groups = std::max<uint64_t>(1, intents.group_count);
+  double group_share = (double)working / groups / config.initial_size;
+  config.flash_incr_mode = H5C_flash_incr__add_space;
+  config.flash_threshold = std::min(1.0, std::max(0.1, group_share));
+  config.flash_multiple = read_only ? 1.0 : 2.0;
+  config.decr_mode = H5C_decr__age_out_with_threshold;
+  config.upper_hr_threshold = std::max(0.999, 1.0 - 1.0 / config.epoch_length);
+  config.apply_empty_reserve = true;
+  config.empty_reserve = read_only ? 0.05 : std::min(0.5, std::max(0.05, group_share));
+  properties.access.metadata.use = true;
+  properties.access.metadata.config_ptr = config;
+  INTENT_LOGINFO("Metadata cache %d to %d bytes for %d objects of file %s",
+                 config.initial_size, config.max_size, objects,
+                 intents.filename.c_str())
+}
+
+/* smallest power of two holding bytes, within [floor, cap]. */
+static hsize_t aggregation_block(uint64_t bytes, hsize_t floor, hsize_t cap) {
+  hsize_t block = floor;
+  while (block < bytes && block < cap) block *= 2;
+  return std::min(block, cap);
+}
+
+/**
+ * Aggregation blocks that hold all of the file's metadata, and all raw data
+ * of its small datasets, so each is written in a few large pieces next to
+ * each other instead of scattered between the large datasets. Small
+ * datasets are the ones below max_block_size. Metadata blocks only grow
+ * from the filesystem block.
+ */
+static void set_aggregation_blocks(FileProperties& properties,
+                                   const FileIOIntents& intents,
+                                   const TuningThresholds& thresholds,
+                                   hsize_t block) {
+  auto datasets = intents.ds_size_dist.find("count");
+  uint64_t dataset_count = datasets == intents.ds_size_dist.end() ? 0 : datasets->second;
+  if (dataset_count == 0) return;
+  uint64_t metadata = dataset_count * METADATA_BYTES_PER_DATASET +
+                      intents.group_count * METADATA_BYTES_PER_GROUP;
+  properties.access.metadata.meta_block_size = aggregation_block(
+      metadata, block, thresholds.max_block_size);
+  uint64_t dataset_size = mean_dataset_size(intents);
+  uint64_t small_data =
+      dataset_size < thresholds.max_block_size ? dataset_size * dataset_count : 0;
+  properties.access.optimizations.small_data_block_size = aggregation_block(
+      small_data, thresholds.small_data_block_size, thresholds.max_block_size);
+  INTENT_LOGINFO("Metadata block %d and small data block %d for file %s",
+                 properties.access.metadata.meta_block_size,
+                 properties.access.optimizations.small_data_block_size,
+                 intents.filename.c_str())
+}
+
+FileProperties HeuristicPolicy::file_properties(
+    const FileIOIntents& intents, const SystemFacts& facts,
+    const TuningThresholds& thresholds) {
+  auto properties = FileProperties();
+  bool is_read_only = intents.mode == FileMode::FILE_READ_ONLY;
+  /* only a candidate here; the VOL reserves the memory when the file is
+   * opened and falls back to the default driver if other open files
+   * already hold the rank's budget. */
+  uint64_t increment = intents.fs_size + thresholds.core_headroom;
+  if (thresholds.core_driver && intents.process_sharing.size() == 1 &&
+      increment <= facts.memory_budget) {
+    properties.access.core = {true, increment, !is_read_only};
+    INTENT_LOGINFO("Core VFD is set to increment %d and flush %d for file %s",
+                   properties.access.core.increment,
+                   properties.access.core.backing_store,
+                   intents.filename.c_str())
+  }
+  /* the core VFD never touches the filesystem, so there is nothing to align. */
+  if (!properties.access.core.use) {
+    const auto& fs = facts.filesystem;
+    hsize_t io_size = fs.io_size();
+    /* writes spanning whole blocks or stripes should start on one, anything
+     * from half a block up would otherwise straddle two. */
+    if (thresholds.filesystem_alignment && mean_transfer_size(intents) >= io_size) {
+      properties.access.alignment = {true, io_size / 2, io_size};
+      INTENT_LOGINFO("Alignment %d from threshold %d on %s for file %s",
+                     io_size, io_size / 2, filesystem_name(fs.type),
+                     intents.filename.c_str())
+    }
+    /* metadata and sieve buffers in block sized pieces, but with a cap
+     * since GPFS blocks reach 16 MB. */
+    hsize_t block = std::min<hsize_t>(io_size, thresholds.max_block_size);
+    properties.access.metadata.use = true;
+    properties.access.metadata.meta_block_size = block;
+    /* locking and reference collection stay as the application set them. */
+    properties.access.optimizations.use = true;
+    properties.access.optimizations.sieve_buf_size = block;
+    properties.access.optimizations.small_data_block_size =
+        thresholds.small_data_block_size;
+    set_aggregation_blocks(properties, intents, thresholds, block);
+    set_page_buffer(properties, intents, facts, thresholds, block);
+  }
+  /* the cache sits above the driver, so even core files need it. */
+  set_metadata_cache(properties, intents, facts, thresholds);
+  /* shared files flush metadata in one collective write instead of each
+   * rank writing its share. Reads go through rank 0 and a broadcast only
+   * if every rank opens every object, which COLLECTIVE files promise. */
+  if (thresholds.collective_metadata && intents.process_sharing.size() > 1) {
+    properties.access.metadata.use = true;
+    properties.access.metadata.enable_coll_metadata_write = true;
+    properties.access.metadata.enable_coll_metadata_ops =
+        intents.sharing_pattern == COLLECTIVE;
+  }
+  return properties;
+}
+
+bool RuleMatch::matches(const SystemFacts& facts, size_t processes,
+                        uint64_t transfer_size, uint64_t file_size) const {
+  return (any_filesystem || facts.filesystem.type == filesystem) &&
+         processes >= min_processes && processes <= max_processes &&
+         transfer_size >= min_transfer_size &&
+         transfer_size <= max_transfer_size && file_size >= min_file_size &&
+         file_size <= max_file_size;
+}
+
+#define RULE_FIELD(j, target, field) \
+  if (j.contains(#field)) j.at(#field).get_to(target.field);
+
+/* keys present in j override thresholds, the rest keep their value. */
+static void apply_thresholds(const json& j, TuningThresholds& thresholds) {
+  RULE_FIELD(j, thresholds, max_chunked_transfer)
+  RULE_FIELD(j, thresholds, chunks_per_process)
+  RULE_FIELD(j, thresholds, core_driver)
+  RULE_FIELD(j, thresholds, core_headroom)
+  RULE_FIELD(j, thresholds, filesystem_alignment)
+  RULE_FIELD(j, thresholds, max_block_size)
+  RULE_FIELD(j, thresholds, small_data_block_size)
+  RULE_FIELD(j, thresholds, page_buffer)
+  RULE_FIELD(j, thresholds, metadata_cache)
+  RULE_FIELD(j, thresholds, collective_metadata)
+}
+
+static RuleMatch to_rule_match(const json& j) {
+  RuleMatch match;
+  if (j.contains("filesystem")) {
+    auto name = j.at("filesystem").get<std::string>();
+    match.any_filesystem = false;
+    match.filesystem = FS_OTHER;
+    for (int type = FS_OTHER; type <= FS_TMPFS; ++type)
+      if (name == filesystem_name((FilesystemType)type))
+        match.filesystem = (FilesystemType)type;
+  }
+  RULE_FIELD(j, match, min_processes)
+  RULE_FIELD(j, match, max_processes)
+  RULE_FIELD(j, match, min_transfer_size)
+  RULE_FIELD(j, match, max_transfer_size)
+  RULE_FIELD(j, match, min_file_size)
+  RULE_FIELD(j, match, max_file_size)
+  return match;
+}
+
+RulesPolicy::RulesPolicy(const std::string& path) : defaults(), rules() {
+  std::ifstream stream(path);
+  if (!stream) throw std::runtime_error("cannot open policy rules " + path);
+  try {
+    auto table = json::parse(stream);
+    if (table.contains("defaults")) apply_thresholds(table.at("defaults"), defaults);
+    if (table.contains("rules")) {
+      for (const auto& entry : table.at("rules")) {
+        Rule rule{RuleMatch(), defaults};
+        if (entry.contains("match")) rule.match = to_rule_match(entry.at("match"));
+        if (entry.contains("set")) apply_thresholds(entry.at("set"), rule.thresholds);
+        rules.push_back(rule);
+      }
+    }
+  } catch (const json::exception& e) {
+    throw std::runtime_error("invalid policy rules " + path + ": " + e.what());
+  }
+}
+
+const TuningThresholds& RulesPolicy::thresholds(const SystemFacts& facts,
+                                                size_t processes,
+                                                uint64_t transfer_size,
+                                                uint64_t file_size) const {
+  for (const auto& rule : rules)
+    if (rule.match.matches(facts, processes, transfer_size, file_size))
+      return rule.thresholds;
+  return defaults;
+}
+
+DatasetProperties RulesPolicy::dataset_properties(
+    const DatasetIOIntents& intents, const SystemFacts& facts) const {
+  return HeuristicPolicy::dataset_properties(
+      intents, facts,
+      thresholds(facts, intents.process_sharing.size(),
+                 most_common_transfer_size(intents), intents.fs_size));
+}
+
+FileProperties RulesPolicy::file_properties(const FileIOIntents& intents,
+                                            const SystemFacts& facts) const {
+  return HeuristicPolicy::file_properties(
+      intents, facts,
+      thresholds(facts, intents.process_sharing.size(),
+                 mean_transfer_size(intents), intents.fs_size));
+}
+
+DatasetProperties CostModelPolicy::dataset_properties(
+    const DatasetIOIntents& intents, const SystemFacts& facts) const {
+  TuningThresholds thresholds;
+  auto properties = HeuristicPolicy::dataset_properties(intents, facts, thresholds);
+  auto profile = machine_profile(intents.filename);
+  auto ranked = rank_dataset_candidates(intents, profile);
+  const auto& best = ranked.front();
+  properties.access.chunk.use = best.chunked;
+  if (best.chunked) {
+    properties.access.chunk.ndims = (int)best.ndims;
+    for (unsigned d = 0; d < best.ndims; ++d)
+      properties.access.chunk.dim[d] = best.chunk[d];
+  }
+  set_chunk_cache(properties, intent_constraints(intents, profile.stripe_size),
+                  best.chunk, intents, facts, best.chunked);
+  set_transfer_mode(properties, intents, best.collective,
+                    thresholds.chunks_per_process);
+  INTENT_LOGINFO("cost model picks %s %s I/O for dataset %s, %f s of %lu candidates",
+                 best.chunked ? "chunked" : "contiguous",
+                 best.collective ? "collective" : "independent",
+                 intents.dataset_name.c_str(), best.cost,
+                 (unsigned long)ranked.size())
+  return properties;
+}
+
+FileProperties CostModelPolicy::file_properties(const FileIOIntents& intents,
+                                                const SystemFacts& facts) const {
+  auto profile = machine_profile(intents.filename);
+  TuningThresholds thresholds;
+  thresholds.core_driver =
+      file_cost(intents, profile, true) < file_cost(intents, profile, false);
+  return HeuristicPolicy::file_properties(intents, facts, thresholds);
+}
+
+PolicyRegistry::PolicyRegistry()
+    : mutex(), factories(), active(std::make_shared<HeuristicPolicy>()) {
+  register_policy("heuristic",
+                  []() { return std::make_unique<HeuristicPolicy>(); });
+  register_policy("rules", []() {
+    const char* path = getenv("H5INTENT_POLICY_RULES");
+    if (path == nullptr)
+      throw std::runtime_error("H5INTENT_POLICY_RULES is not set");
+    return std::make_unique<RulesPolicy>(path);
+  });
+  register_policy("cost", []() { return std::make_unique<CostModelPolicy>(); });
+  const char* name = getenv("H5INTENT_POLICY");
+  if (name != nullptr) select(name);
+}
+
+void PolicyRegistry::register_policy(const std::string& name, Factory factory) {
+  std::lock_guard<std::mutex> lock(mutex);
+  factories[name] = std::move(factory);
+}
+
+std::unique_ptr<TuningPolicy> PolicyRegistry::load_plugin(const std::string& path) {
+  /* never closed, the policy's code has to outlive every copy of it. */
+  void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) throw std::runtime_error(dlerror());
+  auto entry = (PolicyEntryPoint)dlsym(handle, H5INTENT_POLICY_SYMBOL);
+  if (entry == nullptr)
+    throw std::runtime_error(path + " has no " H5INTENT_POLICY_SYMBOL);
+  return std::unique_ptr<TuningPolicy>(entry());
+}
+
+bool PolicyRegistry::select(const std::string& name) {
+  std::unique_ptr<TuningPolicy> created;
+  try {
+    if (name.find('/') != std::string::npos) {
+      created = load_plugin(name);
+    } else {
+      Factory factory;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto iter = factories.find(name);
+        if (iter != factories.end()) factory = iter->second;
+      }
+      if (factory) created = factory();
+    }
+  } catch (const std::exception& e) {
+    INTENT_LOGERROR("policy %s failed: %s", name.c_str(), e.what());
+    return false;
+  }
+  if (created == nullptr) {
+    INTENT_LOGERROR("policy %s is not registered", name.c_str());
+    return false;
+  }
+  INTENT_LOGINFO("using tuning policy %s", created->name());
+  std::lock_guard<std::mutex> lock(mutex);
+  active = std::move(created);
+  return true;
+}
+
+std::shared_ptr<const TuningPolicy> PolicyRegistry::policy() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return active;
+}
+}  // namespace h5intent
@@ -0,0 +1,204 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#ifndef H5INTENT_TUNING_POLICY_H
+#define H5INTENT_TUNING_POLICY_H
+#include <h5intent/filesystem_info.h>
+#include <h5intent/property_dds.h>
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+/**
+ * Translation of intents into HDF5 properties. A policy sees one intent and
+ * the facts of the system it runs on and returns the property set. Policies
+ * are registered by name in the PolicyRegistry, or loaded from a shared
+ * object exporting h5intent_create_policy, and picked with H5INTENT_POLICY.
+ * Intents are translated when a configuration is loaded, or with
+ * H5INTENT_TRANSLATE=lookup the first time their file or dataset is looked up.
+ */
+namespace h5intent {
+struct SystemFacts {
+  FilesystemInfo filesystem;
+  /* bytes a rank may keep in core VFD files. */
+  uint64_t memory_budget;
+  size_t ranks_per_node;
+};
+
+/* facts for the filesystem filename lives on. */
+SystemFacts system_facts(const std::string& filename);
+
+/* knobs of the default heuristic; defaults are the values it always used. */
+struct TuningThresholds {
+  /* transfers above this stay contiguous instead of chunked. */
+  uint64_t max_chunked_transfer = 32ULL * 1024 * 1024;
+  /* chunks one process may contribute to a linked-chunk collective I/O. */
+  unsigned chunks_per_process = 64;
+  bool core_driver = true;
+  /* added to the file size to get the core VFD increment. */
+  uint64_t core_headroom = 1024 * 1024;
+  bool filesystem_alignment = true;
+  /* cap on metadata, small data and sieve buffer blocks. */
+  uint64_t max_block_size = 1024 * 1024;
+  /* smallest small data block. */
+  uint64_t small_data_block_size = 2048;
+  /* paged file space and a page buffer for sub-block transfers; off since
+   * the gain is unmeasured and pages cost a read back on local disks. */
+  bool page_buffer = false;
+  /* metadata cache sized for files with many objects. */
+  bool metadata_cache = true;
+  /* collective metadata reads and writes for shared files. */
+  bool collective_metadata = true;
+};
+
+/* HDF5's default file space page. */
+static const uint64_t MIN_PAGE_SIZE = 4096;
+/* mean transfers gathered into one page. */
+static const uint64_t PAGE_TRANSFERS = 8;
+/* the page buffer may take this share of the rank's memory budget. */
+static const uint64_t PAGE_BUFFER_BUDGET_SHARE = 8;
+static const uint64_t PAGE_BUFFER_DEFAULT_BYTES = 1024 * 1024;
+/* percent of the page buffer kept for raw data. */
+static const unsigned PAGE_BUFFER_MIN_RAW = 50;
+
+/* metadata per dataset: object header and a chunk index node. */
+static const uint64_t METADATA_BYTES_PER_DATASET = 4 * 1024;
+/* and per group: object header, a B-tree node and the local heap. */
+static const uint64_t METADATA_BYTES_PER_GROUP = 8 * 1024;
+/* cache accesses per object in one pass over the file. */
+static const uint64_t METADATA_ACCESSES_PER_OBJECT = 16;
+/* HDF5's default metadata cache sizes; files fitting in it keep it. */
+static const uint64_t METADATA_CACHE_INITIAL_SIZE = 2 * 1024 * 1024;
+static const uint64_t METADATA_CACHE_MAX_SIZE = 32 * 1024 * 1024;
+/* HDF5 rejects larger caches and longer epochs. */
+static const uint64_t METADATA_CACHE_LIMIT = 128 * 1024 * 1024;
+static const uint64_t METADATA_CACHE_MAX_EPOCH = 1000000;
+/* the metadata cache may take this share of the rank's memory budget. */
+static const uint64_t METADATA_CACHE_BUDGET_SHARE = 8;
+
+/* HDF5's default metadata cache configuration (H5AC__DEFAULT_CACHE_CONFIG). */
+H5AC_cache_config_t default_metadata_cache();
+
+class TuningPolicy {
+ public:
+  virtual ~TuningPolicy() = default;
+  virtual const char* name() const = 0;
+  virtual DatasetProperties dataset_properties(const DatasetIOIntents& intents,
+                                               const SystemFacts& facts) const = 0;
+  virtual FileProperties file_properties(const FileIOIntents& intents,
+                                         const SystemFacts& facts) const = 0;
+};
+
+/* the built-in translation, with its constants taken from thresholds. */
+class HeuristicPolicy : public TuningPolicy {
+  TuningThresholds thresholds;
+
+ public:
+  explicit HeuristicPolicy(TuningThresholds thresholds = TuningThresholds());
+  const char* name() const override { return "heuristic"; }
+  DatasetProperties dataset_properties(const DatasetIOIntents& intents,
+                                       const SystemFacts& facts) const override;
+  FileProperties file_properties(const FileIOIntents& intents,
+                                 const SystemFacts& facts) const override;
+  static DatasetProperties dataset_properties(const DatasetIOIntents& intents,
+                                              const SystemFacts& facts,
+                                              const TuningThresholds& thresholds);
+  static FileProperties file_properties(const FileIOIntents& intents,
+                                        const SystemFacts& facts,
+                                        const TuningThresholds& thresholds);
+};
+
+/* conditions of a rule; bounds are inclusive, defaults match anything. */
+struct RuleMatch {
+  bool any_filesystem = true;
+  FilesystemType filesystem = FS_OTHER;
+  size_t min_processes = 0;
+  size_t max_processes = std::numeric_limits<size_t>::max();
+  uint64_t min_transfer_size = 0;
+  uint64_t max_transfer_size = std::numeric_limits<uint64_t>::max();
+  uint64_t min_file_size = 0;
+  uint64_t max_file_size = std::numeric_limits<uint64_t>::max();
+  bool matches(const SystemFacts& facts, size_t processes,
+               uint64_t transfer_size, uint64_t file_size) const;
+};
+
+/**
+ * The heuristic with thresholds read from a JSON table:
+ *   {"defaults": {<threshold>: value, ...},
+ *    "rules": [{"match": {"filesystem": "lustre", "min_processes": 2, ...},
+ *               "set": {<threshold>: value, ...}}, ...]}
+ * The first matching rule's "set" is applied over "defaults". Thresholds are
+ * the TuningThresholds members, match keys the RuleMatch members.
+ */
+class RulesPolicy : public TuningPolicy {
+  struct Rule {
+    RuleMatch match;
+    TuningThresholds thresholds;
+  };
+  TuningThresholds defaults;
+  std::vector<Rule> rules;
+
+ public:
+  /* @throws std::runtime_error if the table cannot be read or parsed. */
+  explicit RulesPolicy(const std::string& path);
+  const char* name() const override { return "rules"; }
+  const TuningThresholds& thresholds(const SystemFacts& facts, size_t processes,
+                                     uint64_t transfer_size,
+                                     uint64_t file_size) const;
+  DatasetProperties dataset_properties(const DatasetIOIntents& intents,
+                                       const SystemFacts& facts) const override;
+  FileProperties file_properties(const FileIOIntents& intents,
+                                 const SystemFacts& facts) const override;
+};
+
+/**
+ * The heuristic, except that the layout, the transfer mode and the core VFD
+ * are the ones the cost model estimates fastest for the machine profile of
+ * the file's directory (see cost_model.h).
+ */
+class CostModelPolicy : public TuningPolicy {
+ public:
+  const char* name() const override { return "cost"; }
+  DatasetProperties dataset_properties(const DatasetIOIntents& intents,
+                                       const SystemFacts& facts) const override;
+  FileProperties file_properties(const FileIOIntents& intents,
+                                 const SystemFacts& facts) const override;
+};
+
+/* symbol a policy plugin exports; the caller owns the returned policy. */
+#define H5INTENT_POLICY_SYMBOL "h5intent_create_policy"
+typedef TuningPolicy* (*PolicyEntryPoint)();
+
+class PolicyRegistry {
+ public:
+  using Factory = std::function<std::unique_ptr<TuningPolicy>()>;
+
+ private:
+  std::mutex mutex;
+  std::unordered_map<std::string, Factory> factories;
+  std::shared_ptr<const TuningPolicy> active;
+  std::unique_ptr<TuningPolicy> load_plugin(const std::string& path);
+
+ public:
+  /* registers "heuristic", "rules" (table from H5INTENT_POLICY_RULES) and
+   * "cost", and selects H5INTENT_POLICY, falling back to "heuristic". */
+  PolicyRegistry();
+  void register_policy(const std::string& name, Factory factory);
+  /**
+   * Make a registered policy, or the plugin at a path (anything with a '/'),
+   * the active one. Properties a snapshot already computed keep the old
+   * policy's values; select_policy() also translates the loaded
+   * configuration again.
+   * @return false, keeping the active policy, if it cannot be created.
+   */
+  bool select(const std::string& name);
+  std::shared_ptr<const TuningPolicy> policy();
+};
+}  // namespace h5intent
+#endif  // H5INTENT_TUNING_POLICY_H
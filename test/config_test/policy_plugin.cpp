@@ -0,0 +1,25 @@
+//
+// Created by haridev on 10/16/26.
+//
+
+#include <h5intent/tuning_policy.h>
+/**
+ * Smallest policy plugin: the heuristic with a fixed chunk, so tests can
+ * tell that the policy loaded from this library is the one that ran.
+ */
+namespace {
+class PluginPolicy : public h5intent::HeuristicPolicy {
+ public:
+  const char* name() const override { return "plugin"; }
+  DatasetProperties dataset_properties(const DatasetIOIntents& intents,
+                                       const h5intent::SystemFacts& facts) const override {
+    auto properties = HeuristicPolicy::dataset_properties(intents, facts);
+    properties.access.chunk = {true, 1, {4343}};
+    return properties;
+  }
+};
+}  // namespace
+
+extern "C" h5intent::TuningPolicy* h5intent_create_policy() {
+  return new PluginPolicy();
+}
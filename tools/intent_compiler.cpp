@@ -0,0 +1,38 @@
+//
+// Created by haridev on 10/16/26.
+//
+/**
+ * Compiles an h5bench_write.json style intent file into the binary image
+ * that the loader can mmap and use in place.
+ *
+ * usage: h5intent_compile <intent.json> <output>
+ */
+#include <h5intent/configuration_loader.h>
+#include <h5intent/intent_stream.h>
+
+#include <fstream>
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <intent.json> <output>\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  std::vector<char> image;
+  try {
+    image = h5intent::compile_intents_file(argv[1]);
+  } catch (const std::exception& e) {
+    fprintf(stderr, "could not parse %s: %s\n", argv[1], e.what());
+    return EXIT_FAILURE;
+  }
+  h5intent::CompiledIntents compiled(image.data(), image.size());
+  std::ofstream output(argv[2], std::ios::binary | std::ios::trunc);
+  output.write(image.data(), image.size());
+  if (!output.good()) {
+    fprintf(stderr, "could not write %s\n", argv[2]);
+    return EXIT_FAILURE;
+  }
+  printf("compiled %zu datasets and %zu files from %s into %s (%zu bytes)\n",
+         compiled.dataset_count(), compiled.file_count(), argv[1], argv[2],
+         image.size());
+  return EXIT_SUCCESS;
+}
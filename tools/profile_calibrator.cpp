@@ -0,0 +1,29 @@
+//
+// Created by haridev on 10/16/26.
+//
+/**
+ * Measures the machine profile the cost policy uses, on the filesystem of a
+ * directory, so a job can point H5INTENT_MACHINE_PROFILE at the result
+ * instead of every rank calibrating at startup. Edit the node, filesystem
+ * and network figures afterwards, a single process cannot measure them.
+ *
+ * usage: h5intent_calibrate <directory> <profile.json>
+ */
+#include <h5intent/configuration_loader.h>
+#include <h5intent/cost_model.h>
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <directory> <profile.json>\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  auto profile = h5intent::calibrate_profile(argv[1]);
+  if (!h5intent::write_profile(argv[2], profile)) {
+    fprintf(stderr, "could not write %s\n", argv[2]);
+    return EXIT_FAILURE;
+  }
+  printf("%s: latency %.1f us, %.0f MB/s per process, %.0f MB/s memcpy\n", argv[1],
+         profile.latency * 1e6, profile.process_bandwidth / (1024 * 1024),
+         profile.memory_bandwidth / (1024 * 1024));
+  return EXIT_SUCCESS;
+}
@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <cpp-logger/clogger.h>
 #define H5_INTENT_LOG_NAME "H5INTENT"
@@ -69,6 +70,10 @@ typedef struct H5VL_intent_t {
   hid_t under_vol_id; /* ID for underlying VOL connector */
   void *under_object; /* Info object for underlying VOL connector */
   char* filename;
+  size_t core_bytes;  /* memory budget reserved for a core VFD file */
+  int telemetry_id;   /* dataset id in the I/O telemetry, -1 if not tracked */
+  int ndims;          /* rank of a tracked dataset's extent, -1 if unknown */
+  hsize_t dims[H5S_MAX_RANK];
 } H5VL_intent_t;
 
 /* The intent VOL wrapper context */
@@ -543,6 +548,9 @@ static H5VL_intent_t *H5VL_intent_new_obj(void *under_obj, hid_t under_vol_id, c
   //printf("From H5VL_intent_new_obj %s %s", filename, new_obj->filename);
   new_obj->under_object = under_obj;
   new_obj->under_vol_id = under_vol_id;
+  new_obj->core_bytes = 0;
+  new_obj->telemetry_id = -1;
+  new_obj->ndims = -1;
   H5Iinc_ref(new_obj->under_vol_id);
   return new_obj;
 } /* end H5VL__intent_new_obj() */
@@ -634,6 +642,7 @@ static herr_t H5VL_intent_term(void) {
 #ifdef ENABLE_INTENT_LOGGING
   H5INTENT_LOGINFO_SIMPLE("------- INTENT VOL TERM");
 #endif
+  dump_dataset_telemetry();
 
   /* Reset VOL ID */
   H5VL_INTENT_g = H5I_INVALID_HID;
@@ -1336,21 +1345,49 @@ static void *H5VL_intent_dataset_create(void *obj,
        * raw data. The unit of measure for dim values is dataset elements.
        * As a side-effect of this function, the layout of the dataset is changed to
        * H5D_CHUNKED, if it is not already so set.
+       *
+       * The chunk from the intents ignores the dataspace, so it is solved
+       * again for this dataspace and datatype.
        */
-      herr_t status = H5Pset_chunk(dcpl_id,
-                                   datasetProperties.access.chunk.ndims,
-                                   datasetProperties.access.chunk.dim);
-      if (status != 0) {
-        H5INTENT_LOGERROR("DATASET setting chunk for dataset %s failed", name_fqn);
+      hsize_t space_dims[H5S_MAX_RANK], space_max_dims[H5S_MAX_RANK];
+      int space_ndims = H5Sget_simple_extent_dims(space_id, space_dims, space_max_dims);
+      size_t element_size = H5Tget_size(type_id);
+      if (space_ndims <= 0) {
+        /* scalar and null dataspaces have nothing to chunk. */
+        H5INTENT_LOGINFO("DATASET skipping chunk for scalar or null dataset %s", name_fqn);
+        datasetProperties.access.chunk_cache.use = false;
       } else {
-        H5INTENT_LOGINFO("DATASET setting chunk for dataset %s successful", name_fqn);
-      }
-      if (datasetProperties.access.chunk.opts > 0) {
-        status = H5Pset_chunk_opts(dcpl_id, datasetProperties.access.chunk.opts);
+        herr_t status = -1;
+        if (element_size > 0 &&
+            get_dataset_chunk(name_fqn, o->filename, space_ndims, space_dims,
+                              space_max_dims, element_size,
+                              datasetProperties.access.chunk.dim)) {
+          datasetProperties.access.chunk.ndims = space_ndims;
+          status = H5Pset_chunk(dcpl_id,
+                                datasetProperties.access.chunk.ndims,
+                                datasetProperties.access.chunk.dim);
+        }
         if (status != 0) {
-          H5INTENT_LOGERROR("DATASET setting chunk opts for dataset %s failed", name_fqn);
-        }else {
-          H5INTENT_LOGINFO("DATASET setting chunk opts for dataset %s successful", name_fqn);
+          H5INTENT_LOGERROR("DATASET setting chunk for dataset %s failed", name_fqn);
+        } else {
+          H5INTENT_LOGINFO("DATASET setting chunk for dataset %s successful", name_fqn);
+          /* the cache from the intents was sized for a guessed chunk. */
+          struct chunk_cache* cache = &datasetProperties.access.chunk_cache;
+          if (get_dataset_chunk_cache(name_fqn, o->filename, space_ndims, space_dims,
+                                      space_max_dims, element_size,
+                                      datasetProperties.access.chunk.dim,
+                                      &cache->rdcc_nslots, &cache->rdcc_nbytes,
+                                      &cache->rdcc_w0)) {
+            cache->use = true;
+          }
+        }
+        if (status == 0 && datasetProperties.access.chunk.opts > 0) {
+          status = H5Pset_chunk_opts(dcpl_id, datasetProperties.access.chunk.opts);
+          if (status != 0) {
+            H5INTENT_LOGERROR("DATASET setting chunk opts for dataset %s failed", name_fqn);
+          }else {
+            H5INTENT_LOGINFO("DATASET setting chunk opts for dataset %s successful", name_fqn);
+          }
         }
       }
     }
@@ -1566,6 +1603,9 @@ static void *H5VL_intent_dataset_create(void *obj,
                              dxpl_id, req);
   if (under) {
     dset = H5VL_intent_new_obj(under, o->under_vol_id,o->filename);
+    dset->telemetry_id = register_dataset_telemetry(name_fqn);
+    if (dset->telemetry_id >= 0)
+      dset->ndims = H5Sget_simple_extent_dims(space_id, dset->dims, NULL);
 
     /* Check for async request */
     if (req && *req) *req = H5VL_intent_new_obj(*req, o->under_vol_id,o->filename);
@@ -1576,6 +1616,88 @@ static void *H5VL_intent_dataset_create(void *obj,
   return (void *)dset;
 } /* end H5VL_intent_dataset_create() */
 
+/*-------------------------------------------------------------------------
+ * Function:    H5VL_intent_cache_extent
+ *
+ * Purpose:     Keeps the extent of a tracked dataset in its object, so
+ *              that reads and writes of the whole dataset are counted
+ *              without asking the under VOL for its dataspace each time.
+ *
+ * Return:      void
+ *
+ *-------------------------------------------------------------------------
+ */
+static void H5VL_intent_cache_extent(H5VL_intent_t *o, hid_t dxpl_id) {
+  H5VL_dataset_get_args_t args;
+  args.op_type = H5VL_DATASET_GET_SPACE;
+  args.args.get_space.space_id = H5I_INVALID_HID;
+  o->ndims = -1;
+  if (H5VLdataset_get(o->under_object, o->under_vol_id, &args, dxpl_id, NULL) < 0)
+    return;
+  o->ndims = H5Sget_simple_extent_dims(args.args.get_space.space_id, o->dims, NULL);
+  H5Sclose(args.args.get_space.space_id);
+} /* end H5VL_intent_cache_extent() */
+
+/*-------------------------------------------------------------------------
+ * Function:    H5VL_intent_plan_chunk_cache
+ *
+ * Purpose:     Sizes the chunk cache of a dataset about to be opened for
+ *              the chunk it was created with. The cache in the intents was
+ *              planned for a guessed chunk, and the real one is only in the
+ *              dataset's creation properties, so the dataset is opened once
+ *              to read its DCPL, dataspace and datatype.
+ *
+ * Return:      true if the dataset is chunked and the cache was planned,
+ *              false if it has no chunk cache to size.
+ *
+ *-------------------------------------------------------------------------
+ */
+static bool H5VL_intent_plan_chunk_cache(H5VL_intent_t *o,
+                                         const H5VL_loc_params_t *loc_params,
+                                         const char *name, const char *name_fqn,
+                                         hid_t dapl_id, hid_t dxpl_id,
+                                         struct chunk_cache *cache) {
+  hsize_t chunk[H5S_MAX_RANK], dims[H5S_MAX_RANK], max_dims[H5S_MAX_RANK];
+  int chunk_ndims = -1, space_ndims = -1;
+  size_t element_size = 0;
+  H5VL_dataset_get_args_t args;
+  void *under = H5VLdataset_open(o->under_object, loc_params, o->under_vol_id,
+                                 name, dapl_id, dxpl_id, NULL);
+  if (under == NULL) return false;
+  args.op_type = H5VL_DATASET_GET_DCPL;
+  args.args.get_dcpl.dcpl_id = H5I_INVALID_HID;
+  if (H5VLdataset_get(under, o->under_vol_id, &args, dxpl_id, NULL) >= 0) {
+    hid_t dcpl_id = args.args.get_dcpl.dcpl_id;
+    if (H5Pget_layout(dcpl_id) == H5D_CHUNKED)
+      chunk_ndims = H5Pget_chunk(dcpl_id, H5S_MAX_RANK, chunk);
+    H5Pclose(dcpl_id);
+  }
+  args.op_type = H5VL_DATASET_GET_SPACE;
+  args.args.get_space.space_id = H5I_INVALID_HID;
+  if (chunk_ndims > 0 &&
+      H5VLdataset_get(under, o->under_vol_id, &args, dxpl_id, NULL) >= 0) {
+    hid_t space_id = args.args.get_space.space_id;
+    space_ndims = H5Sget_simple_extent_dims(space_id, dims, max_dims);
+    H5Sclose(space_id);
+  }
+  args.op_type = H5VL_DATASET_GET_TYPE;
+  args.args.get_type.type_id = H5I_INVALID_HID;
+  if (space_ndims == chunk_ndims &&
+      H5VLdataset_get(under, o->under_vol_id, &args, dxpl_id, NULL) >= 0) {
+    element_size = H5Tget_size(args.args.get_type.type_id);
+    H5Tclose(args.args.get_type.type_id);
+  }
+  H5VLdataset_close(under, o->under_vol_id, dxpl_id, NULL);
+  if (element_size == 0) {
+    H5INTENT_LOGINFO("DATASET %s is not chunked, no chunk cache to size", name_fqn);
+    return false;
+  }
+  return get_dataset_chunk_cache(name_fqn, o->filename, space_ndims, dims,
+                                 max_dims, element_size, chunk,
+                                 &cache->rdcc_nslots, &cache->rdcc_nbytes,
+                                 &cache->rdcc_w0);
+} /* end H5VL_intent_plan_chunk_cache() */
+
 /*-------------------------------------------------------------------------
  * Function:    H5VL_intent_dataset_open
  *
@@ -1667,7 +1789,14 @@ static void *H5VL_intent_dataset_open(void *obj,
        *
        * H5Pset_chunk_cache() sets the number of elements, the total number of bytes, and the preemption policy value in the raw data chunk cache on a dataset access property list. After calling this function, the values set in the property list will override the values in the file's file access property list. The raw data chunk cache inserts chunks into the cache by first computing a hash value using the address of a chunk, then using that hash value as the chunk's index into the table of cached chunks. The size of this hash table, i.e., and the number of possible hash values, is determined by the rdcc_nslots parameter. If a different chunk in the cache has the same hash value, this causes a collision, which reduces efficiency. If inserting the chunk into cache would cause the cache to be too big, then the cache is pruned according to the rdcc_w0 parameter.
        *
+       * The cache from the intents was sized for a guessed chunk, so it is
+       * planned again for the chunk the dataset has.
        */
+      datasetProperties.access.chunk_cache.use = H5VL_intent_plan_chunk_cache(
+          o, loc_params, name, name_fqn, dapl_id, dxpl_id,
+          &datasetProperties.access.chunk_cache);
+    }
+    if (datasetProperties.access.chunk_cache.use) {
       herr_t status = H5Pset_chunk_cache(
           dapl_id, datasetProperties.access.chunk_cache.rdcc_nslots,
           datasetProperties.access.chunk_cache.rdcc_nbytes,
@@ -1699,6 +1828,9 @@ static void *H5VL_intent_dataset_open(void *obj,
                            dapl_id, dxpl_id, req);
   if (under) {
     dset = H5VL_intent_new_obj(under, o->under_vol_id,o->filename);
+    dset->telemetry_id = register_dataset_telemetry(name_fqn);
+    if (dset->telemetry_id >= 0 && (req == NULL || *req == NULL))
+      H5VL_intent_cache_extent(dset, dxpl_id);
 
     /* Check for async request */
     if (req && *req) *req = H5VL_intent_new_obj(*req, o->under_vol_id,o->filename);
@@ -1709,6 +1841,66 @@ static void *H5VL_intent_dataset_open(void *obj,
   return (void *)dset;
 } /* end H5VL_intent_dataset_open() */
 
+/*-------------------------------------------------------------------------
+ * Function:    H5VL_intent_now
+ *
+ * Purpose:     Monotonic clock for timing dataset reads and writes.
+ *
+ * Return:      Nanoseconds
+ *
+ *-------------------------------------------------------------------------
+ */
+static uint64_t H5VL_intent_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/*-------------------------------------------------------------------------
+ * Function:    H5VL_intent_record_io
+ *
+ * Purpose:     Counts a read or write of a tracked dataset in the I/O
+ *              telemetry. The bytes are the selected elements times the
+ *              memory type size; the access is contiguous if the file
+ *              selection is one run of the dataset. H5S_ALL on both sides
+ *              selects the whole dataset, whose extent is kept in the
+ *              object since it was opened or created.
+ *
+ * Return:      void
+ *
+ *-------------------------------------------------------------------------
+ */
+static void H5VL_intent_record_io(H5VL_intent_t *o, bool is_write,
+                                  hid_t mem_type_id, hid_t mem_space_id,
+                                  hid_t file_space_id, uint64_t nanoseconds) {
+  hid_t space_id = file_space_id;
+  hssize_t npoints = 0;
+  bool contiguous = true;
+  if (o->telemetry_id < 0) return;
+  if (space_id == H5S_ALL && mem_space_id != H5S_ALL) space_id = mem_space_id;
+  if (space_id == H5S_ALL) {
+    /* an asynchronous open could not read it yet. */
+    if (o->ndims < 0) H5VL_intent_cache_extent(o, H5P_DATASET_XFER_DEFAULT);
+    npoints = o->ndims >= 0 ? 1 : 0;
+    for (int i = 0; i < o->ndims; ++i) npoints *= o->dims[i];
+  } else if (space_id >= 0) {
+    npoints = H5Sget_select_npoints(space_id);
+    /* the memory space only counts elements, its layout is the buffer's. */
+    if (space_id == file_space_id && npoints > 1 &&
+        H5Sget_select_type(space_id) != H5S_SEL_ALL) {
+      hsize_t dims[H5S_MAX_RANK], start[H5S_MAX_RANK], end[H5S_MAX_RANK];
+      int ndims = H5Sget_simple_extent_dims(space_id, dims, NULL);
+      contiguous = ndims >= 0 &&
+                   H5Sget_select_bounds(space_id, start, end) >= 0 &&
+                   is_contiguous_selection(ndims, dims, start, end, npoints);
+    }
+  }
+  if (npoints < 0) npoints = 0;
+  record_dataset_io(o->telemetry_id, is_write,
+                    (size_t)npoints * H5Tget_size(mem_type_id), contiguous,
+                    nanoseconds);
+}
+
 /*-------------------------------------------------------------------------
  * Function:    H5VL_intent_dataset_read
  *
@@ -1729,8 +1921,12 @@ static herr_t H5VL_intent_dataset_read(void *dset, hid_t mem_type_id,
   H5INTENT_LOGINFO_SIMPLE("DATASET Read");
 #endif
 
+  uint64_t start = H5VL_intent_now();
   ret_value = H5VLdataset_read(o->under_object, o->under_vol_id, mem_type_id,
                                mem_space_id, file_space_id, plist_id, buf, req);
+  if (ret_value >= 0)
+    H5VL_intent_record_io(o, false, mem_type_id, mem_space_id, file_space_id,
+                          H5VL_intent_now() - start);
 
   /* Check for async request */
   if (req && *req) *req = H5VL_intent_new_obj(*req, o->under_vol_id,o->filename);
@@ -1759,9 +1955,13 @@ static herr_t H5VL_intent_dataset_write(void *dset, hid_t mem_type_id,
   H5INTENT_LOGINFO_SIMPLE("DATASET Write");
 #endif
 
+  uint64_t start = H5VL_intent_now();
   ret_value =
       H5VLdataset_write(o->under_object, o->under_vol_id, mem_type_id,
                         mem_space_id, file_space_id, plist_id, buf, req);
+  if (ret_value >= 0)
+    H5VL_intent_record_io(o, true, mem_type_id, mem_space_id, file_space_id,
+                          H5VL_intent_now() - start);
 
   /* Check for async request */
   if (req && *req) *req = H5VL_intent_new_obj(*req, o->under_vol_id,o->filename);
@@ -1825,6 +2025,11 @@ static herr_t H5VL_intent_dataset_specific(void *obj,
   ret_value = H5VLdataset_specific(o->under_object, o->under_vol_id, args,
                                    dxpl_id, req);
 
+  /* the extent kept for the telemetry follows the dataset's. */
+  if (ret_value >= 0 && o->telemetry_id >= 0 &&
+      args->op_type == H5VL_DATASET_SET_EXTENT && o->ndims > 0)
+    memcpy(o->dims, args->args.set_extent.size, o->ndims * sizeof(hsize_t));
+
   /* Check for async request */
   if (req && *req) *req = H5VL_intent_new_obj(*req, under_vol_id,o->filename);
 
@@ -2087,6 +2292,121 @@ static herr_t H5VL_intent_datatype_close(void *dt, hid_t dxpl_id, void **req) {
   return ret_value;
 } /* end H5VL_intent_datatype_close() */
 
+/*-------------------------------------------------------------------------
+ * Function:    H5VL_intent_set_mdc_config
+ *
+ * Purpose:     Sets the metadata cache configuration of the intents on a
+ *              FAPL. The configuration is left unset (version 0) by the
+ *              tuner for files that fit HDF5's default cache.
+ *
+ *-------------------------------------------------------------------------
+ */
+static void H5VL_intent_set_mdc_config(hid_t fapl_id,
+                                       struct FileProperties *fileProperties,
+                                       const char *name) {
+  if (!fileProperties->access.metadata.use ||
+      fileProperties->access.metadata.config_ptr.version == 0)
+    return;
+  herr_t status =
+      H5Pset_mdc_config(fapl_id, &fileProperties->access.metadata.config_ptr);
+  if (status != 0) {
+    H5INTENT_LOGERROR("FILE setting mdc_config for file %s failed", name);
+  } else {
+    H5INTENT_LOGINFO("FILE setting mdc_config for file %s successful", name);
+  }
+}
+
+/*-------------------------------------------------------------------------
+ * Function:    H5VL_intent_set_coll_metadata
+ *
+ * Purpose:     Sets collective metadata writes and, if every rank opens
+ *              every object of the file, collective metadata reads on a
+ *              FAPL. Both need the MPI-IO driver.
+ *
+ *-------------------------------------------------------------------------
+ */
+static void H5VL_intent_set_coll_metadata(hid_t fapl_id,
+                                          const struct FileProperties *fileProperties,
+                                          const char *name) {
+#ifdef H5_HAVE_PARALLEL
+  if (!fileProperties->access.metadata.use) return;
+  if (!fileProperties->access.metadata.enable_coll_metadata_write &&
+      !fileProperties->access.metadata.enable_coll_metadata_ops)
+    return;
+  if (H5Pget_driver(fapl_id) != H5FD_MPIO) {
+    H5INTENT_LOGINFO("FILE skipping collective metadata for non MPI-IO file %s", name);
+    return;
+  }
+  if (fileProperties->access.metadata.enable_coll_metadata_write) {
+    herr_t status = H5Pset_coll_metadata_write(fapl_id, true);
+    if (status != 0) {
+      H5INTENT_LOGERROR("FILE setting coll_metadata_write for file %s failed", name);
+    } else {
+      H5INTENT_LOGINFO("FILE setting coll_metadata_write for file %s successful", name);
+    }
+  }
+  if (fileProperties->access.metadata.enable_coll_metadata_ops) {
+    herr_t status = H5Pset_all_coll_metadata_ops(fapl_id, true);
+    if (status != 0) {
+      H5INTENT_LOGERROR("FILE setting all_coll_metadata_ops for file %s failed", name);
+    } else {
+      H5INTENT_LOGINFO("FILE setting all_coll_metadata_ops for file %s successful", name);
+    }
+  }
+#endif
+}
+
+/*-------------------------------------------------------------------------
+ * Function:    H5VL_intent_set_page_buffer
+ *
+ * Purpose:     Sets the page buffer of the intents on a FAPL. HDF5 only
+ *              buffers pages of files created with paged file space and
+ *              does not support page buffering over MPI-IO.
+ *
+ * Return:      Success:    true
+ *              Failure:    false, also if there is no page buffer to set
+ *
+ *-------------------------------------------------------------------------
+ */
+static bool H5VL_intent_set_page_buffer(hid_t fapl_id,
+                                        const struct FileProperties *fileProperties,
+                                        const char *name) {
+  if (!fileProperties->access.page_buffer.use) return false;
+#ifdef H5_HAVE_PARALLEL
+  if (H5Pget_driver(fapl_id) == H5FD_MPIO) {
+    H5INTENT_LOGINFO("FILE skipping page_buffer_size for MPI-IO file %s", name);
+    return false;
+  }
+#endif
+  herr_t status = H5Pset_page_buffer_size(
+      fapl_id, fileProperties->access.page_buffer.buf_size,
+      fileProperties->access.page_buffer.min_meta_per,
+      fileProperties->access.page_buffer.min_raw_per);
+  if (status != 0) {
+    H5INTENT_LOGERROR("FILE setting page_buffer_size for file %s failed", name);
+    return false;
+  }
+  H5INTENT_LOGINFO("FILE setting page_buffer_size for file %s successful", name);
+  return true;
+}
+
+/*-------------------------------------------------------------------------
+ * Function:    H5VL_intent_load_configuration
+ *
+ * Purpose:     Loads a configuration deferred by a collective load mode
+ *              at the first file create or open of each rank. The
+ *              broadcast spans MPI_COMM_WORLD whatever the file's
+ *              communicator, so a file-per-process run over MPI_COMM_SELF
+ *              still reads it once; without MPI it is read on this rank.
+ *              Once loaded (or in the local mode) this is a flag check.
+ *
+ *-------------------------------------------------------------------------
+ */
+static void H5VL_intent_load_configuration(void) {
+  if (!load_configuration_pending()) return;
+  load_configuration_collective(MPI_COMM_WORLD);
+}
+
 /*-------------------------------------------------------------------------
  * Function:    H5VL_intent_file_create
  *
@@ -2104,6 +2424,7 @@ static void *H5VL_intent_file_create(const char *name, unsigned flags,
   H5VL_intent_t *file;
   hid_t under_fapl_id;
   void *under;
+  size_t core_bytes = 0;
 
 #ifdef ENABLE_INTENT_LOGGING
   H5INTENT_LOGINFO("FILE Create %s", name);
@@ -2115,6 +2436,7 @@ static void *H5VL_intent_file_create(const char *name, unsigned flags,
   /* Make sure we have info about the underlying VOL to be used */
   if (!info) return NULL;
 
+  H5VL_intent_load_configuration();
   struct FileProperties fileProperties;
   bool is_present = get_file_properties(name, &fileProperties);
   if (is_present) {
@@ -2179,6 +2501,8 @@ static void *H5VL_intent_file_create(const char *name, unsigned flags,
         H5INTENT_LOGINFO("FILE setting set_cache for file %s successful", name);
       }
     }
+    H5VL_intent_set_mdc_config(fapl_id, &fileProperties, name);
+    H5VL_intent_set_coll_metadata(fapl_id, &fileProperties, name);
     if (fileProperties.access.fmpiio.use) {}
     else {
       if (fileProperties.access.close.use) {
@@ -2194,14 +2518,20 @@ static void *H5VL_intent_file_create(const char *name, unsigned flags,
               "FILE setting fclose_degree for file %s successful", name);
         }
       }
-      if (fileProperties.access.core.use) {
+      if (fileProperties.access.core.use &&
+          !reserve_core_memory(fileProperties.access.core.increment)) {
+        H5INTENT_LOGINFO("FILE skipping fapl_core for file %s, memory budget "
+                         "is held by open files", name);
+      } else if (fileProperties.access.core.use) {
         herr_t status =
             H5Pset_fapl_core(fapl_id, fileProperties.access.core.increment,
                              fileProperties.access.core.backing_store);
         if (status != 0) {
+          release_core_memory(fileProperties.access.core.increment);
           H5INTENT_LOGERROR("FILE setting fapl_core for file %s failed",
                             name);
         } else {
+          core_bytes = fileProperties.access.core.increment;
           H5INTENT_LOGINFO("FILE setting fapl_core for file %s successful",
                            name);
         }
@@ -2234,25 +2564,41 @@ static void *H5VL_intent_file_create(const char *name, unsigned flags,
         }
       }
       if (fileProperties.access.metadata.use) {
+        if (fileProperties.access.metadata.meta_block_size > 0) {
+          herr_t status = H5Pset_meta_block_size(
+              fapl_id, fileProperties.access.metadata.meta_block_size);
+          if (status != 0) {
+            H5INTENT_LOGERROR("FILE setting meta_block_size for file %s failed",
+                              name);
+          } else {
+            H5INTENT_LOGINFO(
+                "FILE setting meta_block_size for file %s successful", name);
+          }
+        }
       }
       if (fileProperties.access.optimizations.use) {
-        herr_t status = H5Pset_file_locking(
-            fapl_id, fileProperties.access.optimizations.file_locking, 0);
-        if (status != 0) {
-          H5INTENT_LOGERROR("FILE setting file_locking for file %s failed",
-                            name);
-        } else {
-          H5INTENT_LOGINFO(
-              "FILE setting file_locking for file %s successful", name);
+        herr_t status;
+        if (fileProperties.access.optimizations.use_file_locking) {
+          status = H5Pset_file_locking(
+              fapl_id, fileProperties.access.optimizations.file_locking, 0);
+          if (status != 0) {
+            H5INTENT_LOGERROR("FILE setting file_locking for file %s failed",
+                              name);
+          } else {
+            H5INTENT_LOGINFO(
+                "FILE setting file_locking for file %s successful", name);
+          }
         }
-        status = H5Pset_gc_references(
-            fapl_id, fileProperties.access.optimizations.gc_ref);
-        if (status != 0) {
-          H5INTENT_LOGERROR("FILE setting gc_references for file %s failed",
-                            name);
-        } else {
-          H5INTENT_LOGINFO(
-              "FILE setting gc_references for file %s successful", name);
+        if (fileProperties.access.optimizations.use_gc_ref) {
+          status = H5Pset_gc_references(
+              fapl_id, fileProperties.access.optimizations.gc_ref);
+          if (status != 0) {
+            H5INTENT_LOGERROR("FILE setting gc_references for file %s failed",
+                              name);
+          } else {
+            H5INTENT_LOGINFO(
+                "FILE setting gc_references for file %s successful", name);
+          }
         }
         status = H5Pset_sieve_buf_size(
             fapl_id, fileProperties.access.optimizations.sieve_buf_size);
@@ -2274,19 +2620,10 @@ static void *H5VL_intent_file_create(const char *name, unsigned flags,
               name);
         }
       }
-//      if (fileProperties.access.page_buffer.use) {
-//        herr_t status = H5Pset_page_buffer_size(
-//            fapl_id, fileProperties.access.page_buffer.buf_size,
-//            100 - fileProperties.access.page_buffer.min_raw_per,
-//            fileProperties.access.page_buffer.min_raw_per);
-//        if (status != 0) {
-//          H5INTENT_LOGERROR(
-//              "FILE setting page_buffer_size for file %s failed", name);
-//        } else {
-//          H5INTENT_LOGINFO(
-//              "FILE setting page_buffer_size for file %s successful", name);
-//        }
-//      }
+      /* the FCPL above made the file paged. */
+      if (fileProperties.creation.file_space.use &&
+          fileProperties.creation.file_space.strategy == H5F_FSPACE_STRATEGY_PAGE)
+        H5VL_intent_set_page_buffer(fapl_id, &fileProperties, name);
     }
     if (fileProperties.access.split.use) {
     }
@@ -2320,14 +2657,17 @@ static void *H5VL_intent_file_create(const char *name, unsigned flags,
   under = H5VLfile_create(name, flags, fcpl_id, under_fapl_id, dxpl_id, req);
   if (under) {
     file = H5VL_intent_new_obj(under, info->under_vol_id,name);
+    file->core_bytes = core_bytes;
 
     /* Check for async request */
     if (req && *req) *req = H5VL_intent_new_obj(*req, info->under_vol_id,name);
     //strcpy(filename, name);
     //printf("Setting file.open name %s\n", file.filename);
   } /* end if */
-  else
+  else {
     file = NULL;
+    if (core_bytes > 0) release_core_memory(core_bytes);
+  }
 
   /* Close underlying FAPL */
   H5Pclose(under_fapl_id);
@@ -2353,12 +2693,15 @@ static void *H5VL_intent_file_open(const char *name, unsigned flags,
   H5VL_intent_t *file;
   hid_t under_fapl_id;
   void *under;
+  size_t core_bytes = 0;
+  bool page_buffer = false;
 
 #ifdef ENABLE_INTENT_LOGGING
   H5INTENT_LOGINFO_SIMPLE("FILE Open");
 #endif
 
   fix_filename(name);
+  H5VL_intent_load_configuration();
   struct FileProperties fileProperties;
   bool is_present = get_file_properties(name, &fileProperties);
   if (is_present) {
@@ -2366,6 +2709,16 @@ static void *H5VL_intent_file_open(const char *name, unsigned flags,
 #ifdef ENABLE_INTENT_LOGGING
     H5INTENT_LOGINFO("------- INTENT VOL FILE Found properties for file %s", name);
 #endif
+    if (fileProperties.access.alignment.use){
+      herr_t status = H5Pset_alignment(fapl_id,
+                                       fileProperties.access.alignment.threshold,
+                                       fileProperties.access.alignment.alignment_value);
+      if (status != 0) {
+        H5INTENT_LOGERROR("FILE setting set_alignment for file %s failed", name);
+      } else {
+        H5INTENT_LOGINFO("FILE setting set_alignment for file %s successful", name);
+      }
+    }
     if (fileProperties.access.cache.use){
       herr_t status = H5Pset_cache(fapl_id,
                                    fileProperties.access.cache.mdc_nelmts,
@@ -2378,6 +2731,8 @@ static void *H5VL_intent_file_open(const char *name, unsigned flags,
         H5INTENT_LOGINFO("FILE setting set_cache for file %s successful", name);
       }
     }
+    H5VL_intent_set_mdc_config(fapl_id, &fileProperties, name);
+    H5VL_intent_set_coll_metadata(fapl_id, &fileProperties, name);
     if (fileProperties.access.close.use){
       herr_t status = H5Pset_evict_on_close(fapl_id,
                                             fileProperties.access.close.evict);
@@ -2396,14 +2751,20 @@ static void *H5VL_intent_file_open(const char *name, unsigned flags,
         H5INTENT_LOGINFO("FILE setting fclose_degree for file %s successful", name);
       }
     }
-    if (fileProperties.access.core.use) {
+    if (fileProperties.access.core.use &&
+        !reserve_core_memory(fileProperties.access.core.increment)) {
+      H5INTENT_LOGINFO("FILE skipping fapl_core for file %s, memory budget "
+                       "is held by open files", name);
+    } else if (fileProperties.access.core.use) {
       herr_t status = H5Pset_fapl_core(fapl_id,
                                        fileProperties.access.core.increment,
                                        fileProperties.access.core.backing_store);
       if (status != 0) {
+        release_core_memory(fileProperties.access.core.increment);
         H5INTENT_LOGERROR("FILE setting fapl_core for file %s failed",
                           name);
       } else {
+        core_bytes = fileProperties.access.core.increment;
         H5INTENT_LOGINFO(
             "FILE setting fapl_core for file %s successful", name);
       }
@@ -2440,26 +2801,42 @@ static void *H5VL_intent_file_open(const char *name, unsigned flags,
       }
     }
     if (fileProperties.access.metadata.use) {
+      if (fileProperties.access.metadata.meta_block_size > 0) {
+        herr_t status = H5Pset_meta_block_size(
+            fapl_id, fileProperties.access.metadata.meta_block_size);
+        if (status != 0) {
+          H5INTENT_LOGERROR("FILE setting meta_block_size for file %s failed",
+                            name);
+        } else {
+          H5INTENT_LOGINFO(
+              "FILE setting meta_block_size for file %s successful", name);
+        }
+      }
     }
     if (fileProperties.access.optimizations.use) {
-      herr_t status = H5Pset_file_locking(fapl_id,
-                                          fileProperties.access.optimizations.file_locking,
-                                          0);
-      if (status != 0) {
-        H5INTENT_LOGERROR("FILE setting file_locking for file %s failed",
-                          name);
-      } else {
-        H5INTENT_LOGINFO(
-            "FILE setting file_locking for file %s successful", name);
+      herr_t status;
+      if (fileProperties.access.optimizations.use_file_locking) {
+        status = H5Pset_file_locking(fapl_id,
+                                     fileProperties.access.optimizations.file_locking,
+                                     0);
+        if (status != 0) {
+          H5INTENT_LOGERROR("FILE setting file_locking for file %s failed",
+                            name);
+        } else {
+          H5INTENT_LOGINFO(
+              "FILE setting file_locking for file %s successful", name);
+        }
       }
-      status = H5Pset_gc_references(fapl_id,
-                                    fileProperties.access.optimizations.gc_ref);
-      if (status != 0) {
-        H5INTENT_LOGERROR("FILE setting gc_references for file %s failed",
-                          name);
-      } else {
-        H5INTENT_LOGINFO(
-            "FILE setting gc_references for file %s successful", name);
+      if (fileProperties.access.optimizations.use_gc_ref) {
+        status = H5Pset_gc_references(fapl_id,
+                                      fileProperties.access.optimizations.gc_ref);
+        if (status != 0) {
+          H5INTENT_LOGERROR("FILE setting gc_references for file %s failed",
+                            name);
+        } else {
+          H5INTENT_LOGINFO(
+              "FILE setting gc_references for file %s successful", name);
+        }
       }
       status = H5Pset_sieve_buf_size(fapl_id,
                                      fileProperties.access.optimizations.sieve_buf_size);
@@ -2480,17 +2857,7 @@ static void *H5VL_intent_file_open(const char *name, unsigned flags,
             "FILE setting small_data_block_size for file %s successful", name);
       }
     }
-//    if (fileProperties.access.page_buffer.use) {
-//      herr_t status = H5Pset_page_buffer_size(
-//          fapl_id, fileProperties.access.page_buffer.buf_size, fileProperties.access.page_buffer.min_meta_per, fileProperties.access.page_buffer.min_raw_per);
-//      if (status != 0) {
-//        H5INTENT_LOGERROR("FILE setting page_buffer_size for file %s failed",
-//                          name);
-//      } else {
-//        H5INTENT_LOGINFO("FILE setting page_buffer_size for file %s successful",
-//                         name);
-//      }
-//    }
+    page_buffer = H5VL_intent_set_page_buffer(fapl_id, &fileProperties, name);
     if (fileProperties.access.split.use) {
     }
     if (fileProperties.access.write_tracking.use) {
@@ -2523,17 +2890,32 @@ static void *H5VL_intent_file_open(const char *name, unsigned flags,
   H5Pset_vol(under_fapl_id, info->under_vol_id, info->under_vol_info);
 
   /* Open the file with the underlying VOL connector */
-  under = H5VLfile_open(name, flags, under_fapl_id, dxpl_id, req);
+  if (page_buffer) {
+    H5E_BEGIN_TRY {
+      under = H5VLfile_open(name, flags, under_fapl_id, dxpl_id, req);
+    } H5E_END_TRY;
+    /* files not created with paged file space refuse a page buffer. */
+    if (!under) {
+      H5INTENT_LOGINFO("FILE reopening %s without page buffer", name);
+      H5Pset_page_buffer_size(under_fapl_id, 0, 0, 0);
+      under = H5VLfile_open(name, flags, under_fapl_id, dxpl_id, req);
+    }
+  } else {
+    under = H5VLfile_open(name, flags, under_fapl_id, dxpl_id, req);
+  }
   if (under) {
     file = H5VL_intent_new_obj(under, info->under_vol_id,name);
+    file->core_bytes = core_bytes;
 
     /* Check for async request */
     if (req && *req) *req = H5VL_intent_new_obj(*req, info->under_vol_id,name);
     //strcpy(filename, name);
     //printf("Setting file.open name %s\n", filename);
   } /* end if */
-  else
+  else {
     file = NULL;
+    if (core_bytes > 0) release_core_memory(core_bytes);
+  }
 
   /* Close underlying FAPL */
   H5Pclose(under_fapl_id);
@@ -2667,7 +3049,10 @@ static herr_t H5VL_intent_file_close(void *file, hid_t dxpl_id, void **req) {
   if (req && *req) *req = H5VL_intent_new_obj(*req, o->under_vol_id,o->filename);
 
   /* Release our wrapper, if underlying file was closed */
-  if (ret_value >= 0) H5VL_intent_free_obj(o);
+  if (ret_value >= 0) {
+    if (o->core_bytes > 0) release_core_memory(o->core_bytes);
+    H5VL_intent_free_obj(o);
+  }
 
   return ret_value;
 } /* end H5VL_intent_file_close() */